@@ -20,46 +20,192 @@
  * By: Stijn Wouters.
  */
 #include "CFG.h"
+#include "IndexedGrammar.h"
 #include <stdexcept>
 #include <algorithm>
 #include <iterator>
 #include <stack>
+#include <vector>
+#include <bitset>
+#include <cstddef>
+
+namespace {
 
 /**
- * @brief Recursive implementation to get all the subsets of a given set.
+ * @brief Worklist fixpoint: mark the head of each production rule whose body
+ * consists of marked symbols only, until nothing changes. Each production
+ * rule keeps a counter of the symbols in its body that aren't marked yet, so
+ * every symbol of every body is looked at a constant amount of times.
  *
- * @param s The set whose subsets you want to know.
+ * @param productions The production rules.
+ * @param marked The symbols that are marked from the start.
  *
- * @return The subset of the given set.
+ * @return All marked symbols.
  */
-template <class T>
-std::set< std::set<T> > subset(std::set<T>& s) {
-    if (s.empty()) {
-        // base case
-        return { std::set<T>{} };
-    } else {
-        // recursion: remove one element from the subset
-        T i = *(s.begin());
-        s.erase(s.begin());
-
-        // get all the subset of the set without the first element
-        std::set< std::set<T> > recursion = subset(s);
-
-        // now, add the removed element in all those subset found
-        std::set< std::set<T> > result;
-
-        for (std::set<T> r : recursion) {
-            r.insert(i);
-
-            result.insert(r);
+std::set<char> markHeads(
+    const std::multimap<char, SymbolString>& productions,
+    const std::set<char>& marked
+    ) {
+    std::vector<bool> isMarked(256, false);
+    std::stack<char> worklist;
+
+    for (const char& s : marked) {
+        isMarked[static_cast<unsigned char>(s)] = true;
+    } // end for
+
+    // for each symbol the production rules (one for each occurrence) in
+    // whose body it appears
+    std::vector< std::vector<std::size_t> > occurrences(256);
+    std::vector<std::size_t> counters;
+    std::vector<char> heads;
+
+    for (const auto& p : productions) {
+        const std::size_t index = heads.size();
+        std::size_t counter = 0;
+
+        for (const char& s : p.second) {
+            if (isMarked[static_cast<unsigned char>(s)])
+                continue;
+
+            occurrences[static_cast<unsigned char>(s)].push_back(index);
+            ++counter;
+        } // end for
+
+        heads.push_back(p.first);
+        counters.push_back(counter);
+
+        if (counter == 0 && !isMarked[static_cast<unsigned char>(p.first)]) {
+            isMarked[static_cast<unsigned char>(p.first)] = true;
+            worklist.push(p.first);
+        } // end if
+    } // end for
+
+    while (!worklist.empty()) {
+        const char s = worklist.top();
+        worklist.pop();
+
+        for (const std::size_t& p : occurrences[static_cast<unsigned char>(s)]) {
+            if (--counters[p] != 0 || isMarked[static_cast<unsigned char>(heads[p])])
+                continue;
+
+            isMarked[static_cast<unsigned char>(heads[p])] = true;
+            worklist.push(heads[p]);
         } // end for
+    } // end while
 
-        // finally, return the result + recursion
-        result.insert(recursion.begin(), recursion.end());
-        return result;
-    } // end if-else
+    std::set<char> result;
+
+    for (unsigned int s = 0; s < 256; ++s) {
+        if (isMarked[s])
+            result.insert(static_cast<char>(s));
+    } // end for
+
+    return result;
+}
+
+/**
+ * @brief For each variable the variables that are the body of one of its
+ * unit productions.
+ */
+std::vector< std::vector<char> > unitSuccessors(
+    const std::set<char>& variables,
+    const std::multimap<char, SymbolString>& productions
+    ) {
+    std::vector< std::vector<char> > successors(256);
+
+    for (const auto& p : productions) {
+        if (p.second.size() == 1 && variables.find(p.second.at(0)) != variables.end())
+            successors[static_cast<unsigned char>(p.first)].push_back(p.second.at(0));
+    } // end for
+
+    return successors;
 }
 
+/**
+ * @brief Tarjan's algorithm on the graph of unit productions. A component is
+ * finished only after all components reachable from it, so the variables
+ * reachable from a component are the variables of the component together
+ * with the ones reachable from the successors outside of it.
+ */
+class UnitComponents {
+public:
+    explicit UnitComponents(const std::vector< std::vector<char> >& successors)
+        : fSuccessors(successors), fIndex(256, -1), fLow(256, 0),
+          fOnStack(256, false), fCounter(0), fReach(256) {
+    }
+
+    /**
+     * @brief Get the variables reachable from v by unit productions (v
+     * included).
+     */
+    const std::bitset<256>& reach(const char& v) {
+        const unsigned char u = static_cast<unsigned char>(v);
+
+        if (fIndex[u] == -1)
+            this->visit(u);
+
+        return fReach[u];
+    }
+
+private:
+    void visit(const unsigned char& v) {
+        fIndex[v] = fLow[v] = fCounter++;
+        fStack.push_back(v);
+        fOnStack[v] = true;
+
+        for (const char& s : fSuccessors[v]) {
+            const unsigned char w = static_cast<unsigned char>(s);
+
+            if (fIndex[w] == -1) {
+                this->visit(w);
+                fLow[v] = std::min(fLow[v], fLow[w]);
+            } else if (fOnStack[w]) {
+                fLow[v] = std::min(fLow[v], fIndex[w]);
+            } // end if-else
+        } // end for
+
+        if (fLow[v] != fIndex[v])
+            return;
+
+        // v is the root of a component, pop it from the stack
+        std::vector<unsigned char> component;
+        std::bitset<256> reach;
+
+        unsigned char w;
+        do {
+            w = fStack.back();
+            fStack.pop_back();
+            fOnStack[w] = false;
+
+            component.push_back(w);
+            reach.set(w);
+        } while (w != v);
+
+        for (const unsigned char& c : component) {
+            for (const char& s : fSuccessors[c]) {
+                if (!reach.test(static_cast<unsigned char>(s)))
+                    reach |= fReach[static_cast<unsigned char>(s)];
+            } // end for
+        } // end for
+
+        for (const unsigned char& c : component) {
+            fReach[c] = reach;
+        } // end for
+    }
+
+    const std::vector< std::vector<char> >& fSuccessors;
+
+    std::vector<int> fIndex;
+    std::vector<int> fLow;
+    std::vector<bool> fOnStack;
+    std::vector<unsigned char> fStack;
+    int fCounter;
+
+    std::vector< std::bitset<256> > fReach;
+};
+
+} // end namespace
+
 CFG::CFG(
     const std::set<char>& terminals,
     const std::set<char>& variables,
@@ -67,6 +213,8 @@ CFG::CFG(
     const char& start
     ) : fTerminals(terminals), fVariables(variables), 
         fProductions(productions), fStartSymbol(start) {
+    const auto begin = std::chrono::steady_clock::now();
+
     // check the preconditions
 
     // the intersection of the set of variables and the set of terminals
@@ -110,6 +258,12 @@ CFG::CFG(
     // starting symbol is in the set of variables?
     if (fVariables.find(fStartSymbol) == fVariables.end())
         throw std::invalid_argument("Invalid start symbol.");
+
+    this->uniqueProductions();
+    this->recordStage("input", begin);
+}
+
+CFG::CFG(const char& start) : fStartSymbol(start) {
 }
 
 CFG::~CFG() {
@@ -122,365 +276,276 @@ std::set<SymbolString> CFG::bodies(const char& v) const {
         throw std::invalid_argument("Symbol is not in the set of variables.");
 
     // the set of all bodies with the passed variable v as head
-    std::set<SymbolString> bodies;
-
-    auto range = fProductions.equal_range(v);
-    for (auto it = range.first; it != range.second; ++it) {
-        bodies.insert(it->second);
-    } // end for
+    const BodyRange range = this->bodyRange(v);
 
-    return bodies;
+    return std::set<SymbolString>(range.begin(), range.end());
 }
 
-std::set<char> CFG::nullable() const {
-    std::set<char> nullables;
+BodyRange CFG::bodyRange(const char& v) const {
+    // first check whether the variable is in the set of variables
+    if (fVariables.find(v) == fVariables.end())
+        throw std::invalid_argument("Symbol is not in the set of variables.");
 
-    unsigned int size_before = nullables.size();
+    auto range = fProductions.equal_range(v);
+    return BodyRange(range.first, range.second);
+}
 
-    // base case: all variables having an production A -> "" is surely nullable
-    for (const char& v : fVariables) {
-        for (SymbolString body : this->bodies(v)) {
-            if (body.empty()) {
-                nullables.insert(v);
-                break;
-            } else {
-                continue;
-            } // end if-else
-        } // end for
-    } // end for
+std::set<char> CFG::nullable() const {
+    // base case: all variables having an production A -> "" are surely
+    // nullable, inductive part: all variables having a production whose body
+    // consists only of nullable variables are also nullable
+    return markHeads(fProductions, std::set<char>());
+}
 
-    unsigned int size_after = nullables.size();
+void CFG::eleminateEpsilonProductions(const EpsilonElimination& mode) {
+    // the steps of cleaning up are done on the integer symbols
+    IndexedGrammar grammar(*this);
+    grammar.eleminateEpsilonProductions(mode);
 
-    // inductive part: all variables having a production whose body consists
-    // only of nullable variables are also nullable
+    this->setGrammar(grammar, true);
+    return;
+}
 
-    // keep going until no new symbols were found
-    while (size_before != size_after) {
-        size_before = nullables.size();
+std::set< std::pair<char, char> > CFG::units() const {
+    // the set of unit pairs
+    std::set< std::pair<char, char> > units;
 
-        for (const char& v : fVariables) {
-            // if the key is already found to be nullable, skip them
-            if (nullables.find(v) != nullables.end())
-                continue;
+    // for each variable the variables that are the body of one of its unit
+    // productions
+    const std::vector< std::vector<char> > successors = unitSuccessors(fVariables, fProductions);
 
-            for (const SymbolString& body : this->bodies(v)) {
-                // iterate over each symbol in the body and check whether they
-                // all are nullable
-                bool isNullable = true;
-
-                for (const char& s : body) {
-                    if (nullables.find(s) == nullables.end()) {
-                        isNullable = false;
-                        break;
-                    } else {
-                        continue;
-                    } // end if-else
-                } // end for
-
-                // if all symbols in the body were nullable, then the head
-                // is also nullable and so add them to the set of nullable 
-                // symbols
-                if (isNullable) {
-                    nullables.insert(v);
-                    break;
-                } else {
-                    continue;
-                } // end if-else
-            } // end for
-        } // end for
+    // from each variable, follow the unit productions: (A, A) is a unit
+    // pair and if (A, B) is a unit pair and B --> C a production, then (A, C)
+    // is also one
+    for (const char& v : fVariables) {
+        std::vector<bool> found(256, false);
+        std::stack<char> worklist;
 
-        size_after = nullables.size();
-    } // end while
+        found[static_cast<unsigned char>(v)] = true;
+        worklist.push(v);
+        units.insert(std::pair<char, char>(v, v));
 
-    return nullables;
-}
+        while (!worklist.empty()) {
+            const char u = worklist.top();
+            worklist.pop();
 
-void CFG::eleminateEpsilonProductions() {
-    // first, find all nullable symbols
-    std::set<char> nullables = this->nullable();
-
-    for (const char& v : nullables) { 
-        // the new set of production rules for this variable
-        std::multimap<char, SymbolString> newRules;
-
-        // get the bodies of this production rule
-        for (const SymbolString& body : this->bodies(v)) {
-            // get the indexes of symbols that are nullable
-            std::set<int> indexes;
-            for (unsigned int i = 0; i < body.size(); ++i) {
-                if (nullables.find(body.at(i)) != nullables.end())
-                    indexes.insert(i);
-            } // end for
+            for (const char& w : successors[static_cast<unsigned char>(u)]) {
+                // check whether this is not the original variable
+                if (w == v)
+                    throw std::runtime_error("Cyclic unit pairs detected.");
 
-            // now generate all the bodies that are a result from wheter or
-            // not removing the symbols that were nullable, you'll need the
-            // subset of the indexes (Binomial theorem)
-            for (const auto& s : subset(indexes)) {
-                // copy, because you don't want to touch onto the original body
-                SymbolString b = body;
-
-                // remove some nullable symbols
-                int i = 0; // amount of erased symbols
-                for (const int& k : s) {
-                    b.erase(k-i, 1);
-                    ++i;
-                } // end for
-
-                // skip if the body is already empty (we don't want that into
-                // our new production)
-                if (b.empty())
+                if (found[static_cast<unsigned char>(w)])
                     continue;
 
-                // add them to the new productions
-                newRules.insert(std::pair<char, SymbolString>(v, b));
+                found[static_cast<unsigned char>(w)] = true;
+                worklist.push(w);
+                units.insert(std::pair<char, char>(v, w));
             } // end for
-        } // end for
-
-        // replace the old rules by the new
-        fProductions.erase(v);
-        fProductions.insert(newRules.begin(), newRules.end());
+        } // end while
     } // end for
-    return;
+
+    return units;
 }
 
-std::set< std::pair<char, char> > CFG::units() const {
+std::set< std::pair<char, char> > CFG::unitClosure() const {
     // the set of unit pairs
     std::set< std::pair<char, char> > units;
 
-    unsigned int size_before = units.size();
+    const std::vector< std::vector<char> > successors = unitSuccessors(fVariables, fProductions);
+    UnitComponents components(successors);
 
-    // all unit pairs from a character found so far
-    std::map<char, std::set<char> > found_units;;
-
-    // first the base case, (A, A) for A is all variable is an unit pair
     for (const char& v : fVariables) {
-        units.insert( std::pair<char, char>(v, v) );
+        const std::bitset<256>& reach = components.reach(v);
 
-        std::set<char> s = {v};
-        found_units.insert( std::pair<char, std::set<char> >(v, s) );
+        for (unsigned int w = 0; w < 256; ++w) {
+            if (reach.test(w))
+                units.insert(std::pair<char, char>(v, static_cast<char>(w)));
+        } // end for
     } // end for
 
-    unsigned int size_after = units.size();
-
-    // keep going untill no new unit pairs were found
-    while (size_before != size_after) {
-        size_before = units.size();
-
-        for (auto& p : found_units) {
-            for (const char& v : p.second) {
-                for (const auto& b : this->bodies(v)) {
-                    if (
-                            b.size() == 1 
-                            && fVariables.find(b.at(0)) != fVariables.end()
-                        ) {
-                        // check whether this is not the original variable
-                        if (b.at(0) == p.first)
-                            throw std::runtime_error("Cyclic unit pairs detected.");
-
-                        units.insert(std::pair<char, char>(p.first, b.at(0)));
-
-                        p.second.insert(b.at(0));
-                    } else {
-                        continue;
-                    } // end if-else
-                } // end for
+    return units;
+}
+
+void CFG::eleminateUnitProductions(const UnitElimination& mode) {
+    IndexedGrammar grammar(*this);
+    grammar.eleminateUnitProductions(mode);
+
+    this->setGrammar(grammar, true);
+    return;
+}
+
+std::set<char> CFG::generating() const {
+    // base case: all terminal symbols are generating, inductive part: all
+    // variables having a production whose body consists only of generating
+    // symbols are also generating
+    return markHeads(fProductions, fTerminals);
+}
+
+std::set<char> CFG::reachable() const {
+    // base case: the start symbol is surely reachable
+    std::set<char> reachable = {fStartSymbol};
+    std::stack<char> worklist;
+    worklist.push(fStartSymbol);
+
+    // inductive part: all symbols in the bodies from productions with as head
+    // a variable that is reachable, are also reachable (terminals don't have
+    // any production rules)
+    while (!worklist.empty()) {
+        const char s = worklist.top();
+        worklist.pop();
+
+        auto range = fProductions.equal_range(s);
+        for (auto it = range.first; it != range.second; ++it) {
+            for (const char& c : it->second) {
+                if (reachable.insert(c).second)
+                    worklist.push(c);
             } // end for
         } // end for
-                
-        size_after = units.size();
     } // end while
 
-    return units;
+    return reachable;
 }
 
-void CFG::eleminateUnitProductions() {
-    // first, get all unit pairs
-    std::set< std::pair<char, char> > units = this->units();
-
-    // the new set of production rules
-    std::multimap<char, SymbolString> newProductions;
-
-    for (const auto& u : units) {
-        // the bodies from the second variable are also the bodies of first
-        // variable in the unit pairs
-        // note that this never throws an exception, since unit pairs consists
-        // of variables only
-        for (const SymbolString& body : this->bodies(u.second)) {
-            // ignore if the body is of length 1 and is a variable (we
-            // actually want to remove the unit productions and not creating
-            // another new one)
-            if (body.size() == 1 && fVariables.find(body.at(0)) != fVariables.end())
-                continue;
+void CFG::eleminateUselessSymbols() {
+    IndexedGrammar grammar(*this);
+    grammar.eleminateUselessSymbols();
 
-            // add the new rule
-            newProductions.insert(std::pair<char, SymbolString>(u.first, body));
-        } // end for
-    } // end for
+    this->setGrammar(grammar, true);
+    return;
+}
 
-    // replace the old production rules by the new production rules
-    fProductions = newProductions;
+void CFG::cleanUp(const EpsilonElimination& mode, const UnitElimination& unitMode) {
+    // convert only once for all the steps, the stages are recorded by the
+    // IndexedGrammar
+    IndexedGrammar grammar(*this);
+    grammar.cleanUp(mode, unitMode);
+
+    // also removes all variables which don't have any production rule
+    this->setGrammar(grammar, false);
+    fStats = grammar.stats();
     return;
 }
 
-std::set<char> CFG::generating() const {
-    unsigned int size_before = 0;
+void CFG::recordStage(const std::string& stage, const std::chrono::steady_clock::time_point& begin) {
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+    StageStats stats;
+    stats.stage = stage;
+    stats.variables = fVariables.size();
+    stats.productions = fProductions.size();
+    stats.symbols = 0;
+    stats.seconds = elapsed.count();
+
+    for (const auto& p : fProductions) {
+        stats.symbols += p.second.size();
+    } // end for
 
-    // base case, all terminal symbols are generating
-    std::set<char> generating = fTerminals;
+    fStats.stages.push_back(stats);
+}
 
-    unsigned int size_after = generating.size();
+void CFG::uniqueProductions() {
+    auto first = fProductions.begin();
 
-    // inductive part: all variables having a production whose body consists
-    // only of generating symbols are also generating
+    while (first != fProductions.end()) {
+        const char head = first->first;
+        auto last = first;
+        bool sorted = true;
 
-    // keep going until no new nullable symbols were found
-    while (size_before != size_after) {
-        size_before = generating.size();
+        // the bodies of the head, checking whether each one is bigger than
+        // the one before
+        for (++last; last != fProductions.end() && last->first == head; ++last) {
+            auto previous = last;
+            --previous;
 
-        for (const char& v : fVariables) {
-            // if the variable is already generating, skip them
-            if (generating.find(v) != generating.end())
-                continue;
+            if (!(previous->second < last->second))
+                sorted = false;
+        } // end for
 
-            for (const SymbolString& body : this->bodies(v)) {
-                // iterate over each symbol in the body and check whether they
-                // are generating
-                bool isGenerating = true;
-
-                for (const char& s : body) {
-                    if (generating.find(s) == generating.end()) {
-                        isGenerating = false;
-                        break;
-                    } else {
-                        continue;
-                    } // end if-else
-                } // end for
-
-                // if all symbols in the body were generating, then the head
-                // is also generating and thus insert in the set of generating
-                // symbols
-                if (isGenerating) {
-                    generating.insert(v);
-                    break;
-                } else {
-                    continue;
-                } // end if-else
+        if (!sorted) {
+            const std::set<SymbolString> unique = this->bodies(head);
+
+            // inserting right before the next head keeps the sorted order
+            fProductions.erase(first, last);
+            for (const SymbolString& body : unique) {
+                fProductions.insert(last, std::pair<char, SymbolString>(head, body));
             } // end for
-        } // end for
+        } // end if
 
-        size_after = generating.size();
-    } // end for
+        first = last;
+    } // end while
+}
+
+void CFG::setProductions(const std::map< char, std::set<SymbolString> >& productions) {
+    fProductions.clear();
 
-    return generating;
+    for (const auto& p : productions) {
+        for (const SymbolString& body : p.second) {
+            fProductions.insert(fProductions.end(), std::pair<char, SymbolString>(p.first, body));
+        } // end for
+    } // end for
 }
 
-std::set<char> CFG::reachable() const {
-    unsigned int size_before = 0;
+std::vector<char> CFG::setGrammar(const IndexedGrammar& grammar, const bool& keepVariables) {
+    const unsigned int size = grammar.variables();
 
-    // base case: the start symbol is surely reachable
-    std::set<char> reachable = {fStartSymbol};
+    // the variables that stay
+    std::vector<bool> kept(size, keepVariables);
 
-    unsigned int size_after = reachable.size();
+    for (std::size_t p = 0; p < grammar.productions(); ++p) {
+        kept[IndexedGrammar::toIndex(grammar.head(p))] = true;
+    } // end for
 
-    // inductive part: all symbols in the bodies from productions with as head
-    // a variable that is reachable, are also reachable
-    while (size_before != size_after) {
-        size_before = reachable.size();
-
-        for (const char& s : reachable) {
-            try {
-                // all symbols of the bodies are also reachable
-                for (const SymbolString& body : this->bodies(s)) {
-                    for (const char& c : body) {
-                        reachable.insert(c);
-                    } // end for
-                } // end for
-            } catch (const std::invalid_argument& e) {
-                // you only reach here if the symbol s was a terminal (and
-                // thus cannot have a body in the production rules
-                continue;
-            } // end try-catch
-        } // end for
+    // the characters in use, the new variables get the first free ones
+    std::vector<bool> used(256, false);
+    used[static_cast<unsigned char>(fStartSymbol)] = true;
 
-        size_after = reachable.size();
+    for (const char& t : fTerminals) {
+        used[static_cast<unsigned char>(t)] = true;
     } // end for
 
-    return reachable;
-}
+    for (unsigned int v = 0; v < size; ++v) {
+        if (kept[v])
+            used[static_cast<unsigned char>(grammar.name(IndexedGrammar::variable(v)))] = true;
+    } // end for
 
-void CFG::eleminateUselessSymbols() {
-    // first, get all the generating symbols
-    std::set<char> generating = this->generating();
-
-    // the new set of production rules
-    std::multimap<char, SymbolString> newProductions;
-
-    // first, eleminate all symbols that are not generating
-    for (const char& s : generating) {
-        try {
-            // only add rules whose body does not contain any 
-            // non-generating symbols
-            for (const SymbolString& body : this->bodies(s)) {
-                // first check whether the body does not contain
-                // any non-generating symbols, if so, skip it
-                bool isGenerating = true;
-                for (const char& c : body) {
-                    if (generating.find(c) == generating.end()) {
-                        isGenerating = false;
-                        break;
-                    } else {
-                        continue;
-                    } // end if-else
-                } // end for
-
-                // add them if the body consists of generating symbols
-                if (isGenerating)
-                    newProductions.insert(std::pair<char, SymbolString>(s, body));
-            } // end for
-        } catch (const std::invalid_argument& e) {
-            // you only reach here if the symbol s was a terminal (and
-            // thus cannot have a body in the production rules
+    std::vector<char> names(size, 0);
+    unsigned int next = 1;
+    fVariables.clear();
+
+    for (unsigned int v = 0; v < size; ++v) {
+        if (!kept[v])
             continue;
-        } // end try-catch
-    } // end for
 
-    fProductions = newProductions;
-    // now we have a set of production rules only containing generating
-    // symbols, our next step is to eleminate non-reachable symbols
+        char name = grammar.name(IndexedGrammar::variable(v));
 
-    // get the set of all reachable symbols
-    std::set<char> reachable = this->reachable();
+        if (name == 0) {
+            while (next < 256 && used[next]) {
+                ++next;
+            } // end while
 
-    for (const char& v : fVariables) {
-        // if the variable is not reachable, then remove the rules
-        // and also remove it from the set of variables, because it's
-        // useless now
-        if (reachable.find(v) == reachable.end())
-            fProductions.erase(v);
+            if (next == 256)
+                throw std::runtime_error("Too many variables, use IndexedGrammar instead.");
+
+            name = static_cast<char>(next++);
+        } // end if
+
+        names[v] = name;
+        fVariables.insert(name);
     } // end for
 
-    return;
-}
+    std::map< char, std::set<SymbolString> > productions;
 
-void CFG::cleanUp() {
-    // this one is easy now, just clean up in this order
-    this->eleminateEpsilonProductions();
-    this->eleminateUnitProductions();
-    this->eleminateUselessSymbols();
+    for (std::size_t p = 0; p < grammar.productions(); ++p) {
+        SymbolString body;
 
-    // now, also remove all symbols from the set of the variables which
-    // don't have any production rule
-    std::stack<char> to_be_removed;
+        for (unsigned int k = 0; k < grammar.bodySize(p); ++k) {
+            const Symbol& s = grammar.body(p)[k];
+            body += IndexedGrammar::isTerminal(s) ? IndexedGrammar::toTerminal(s) : names[IndexedGrammar::toIndex(s)];
+        } // end for
 
-    for (const char& v : fVariables) {
-        if ((this->bodies(v)).empty())
-            to_be_removed.push(v);
+        productions[names[IndexedGrammar::toIndex(grammar.head(p))]].insert(body);
     } // end for
 
-    while (!to_be_removed.empty()) {
-        fVariables.erase(to_be_removed.top());
-        to_be_removed.pop();
-    } // end while
-
-    return;
+    this->setProductions(productions);
+    return names;
 }
@@ -26,6 +26,12 @@
 #include <set>
 #include <map>
 #include <string>
+#include <vector>
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+
+class IndexedGrammar;
 
 /**
  * @brief A consisting of symbols from either the set of variables or the 
@@ -34,7 +40,125 @@
 typedef std::string SymbolString;
 
 /**
- * @brief Class representing a context free grammar.
+ * @brief The ways to eleminate epsilon productions.
+ */
+enum EpsilonElimination {
+    // for each body, add a body for each subset of its nullable symbols
+    // left out (exponential in the amount of nullable symbols of a body)
+    EPSILON_SUBSETS,
+
+    // first split the bodies with more than two nullable symbols into
+    // bodies of two symbols, then leave out nullable symbols (polynomial)
+    EPSILON_BINARIZED
+};
+
+/**
+ * @brief The ways to eleminate unit productions.
+ */
+enum UnitElimination {
+    // use the unit pairs of CFG::units(), cycles of unit productions are not
+    // allowed
+    UNITS_ACYCLIC,
+
+    // use the unit pairs of CFG::unitClosure(), cycles of unit productions
+    // are collapsed first
+    UNITS_CONDENSED
+};
+
+/**
+ * @brief The ways to split long bodies into bodies of two symbols when
+ * converting to Chomsky Normal Form. A body ABCD becomes ((AB)C)D.
+ */
+enum Binarization {
+    // a new variable for each prefix of each body
+    BINARIZE_FRESH,
+
+    // one variable for each distinct prefix, shared by all bodies starting
+    // with it
+    BINARIZE_SHARED
+};
+
+/**
+ * @brief The size of a grammar after one stage of cleaning it up or
+ * converting it to Chomsky Normal Form, and the time that stage took.
+ */
+struct StageStats {
+    std::string stage;
+    std::size_t variables;
+    std::size_t productions;
+
+    // the total length of the bodies
+    std::size_t symbols;
+
+    double seconds;
+};
+
+/**
+ * @brief The stages a grammar went through, in order, see CFG::getStats().
+ * The first stage is "input", the grammar as it was constructed.
+ */
+struct GrammarStats {
+    std::vector<StageStats> stages;
+};
+
+/**
+ * @brief The bodies of the production rules with the same head. This is a
+ * view on the production rules of a CFG, so nothing is copied, but it
+ * becomes invalid as soon as the production rules change. Iterating over it
+ * gives the same bodies in the same order as CFG::bodies().
+ */
+class BodyRange {
+public:
+    typedef std::multimap<char, SymbolString>::const_iterator ProductionIterator;
+
+    /**
+     * @brief Iterator over the bodies of the range.
+     */
+    class const_iterator : public std::iterator<std::forward_iterator_tag, const SymbolString> {
+    public:
+        const_iterator() {}
+        explicit const_iterator(const ProductionIterator& it) : fIt(it) {}
+
+        const SymbolString& operator*() const { return fIt->second; }
+        const SymbolString* operator->() const { return &(fIt->second); }
+
+        const_iterator& operator++() { ++fIt; return *this; }
+        const_iterator operator++(int) { const_iterator it = *this; ++fIt; return it; }
+
+        bool operator==(const const_iterator& other) const { return fIt == other.fIt; }
+        bool operator!=(const const_iterator& other) const { return fIt != other.fIt; }
+
+    private:
+        ProductionIterator fIt;
+    };
+
+    /**
+     * @brief Constructor, the bodies of the production rules in [first, last).
+     */
+    BodyRange(const ProductionIterator& first, const ProductionIterator& last)
+        : fFirst(first), fLast(last) {}
+
+    const_iterator begin() const { return const_iterator(fFirst); }
+    const_iterator end() const { return const_iterator(fLast); }
+
+    /**
+     * @brief Check whether there are no bodies.
+     */
+    bool empty() const { return fFirst == fLast; }
+
+    /**
+     * @brief Get the amount of bodies (linear in the amount).
+     */
+    std::size_t size() const { return std::distance(fFirst, fLast); }
+
+private:
+    ProductionIterator fFirst;
+    ProductionIterator fLast;
+};
+
+/**
+ * @brief Class representing a context free grammar. Cleaning it up is done
+ * on an IndexedGrammar, converting back and forth.
  */
 class CFG {
 public:
@@ -87,6 +211,17 @@ public:
      */
     std::set<SymbolString> bodies(const char& v) const;
 
+    /**
+     * @brief Get the bodies with the passed variable as head just as
+     * bodies(), but without copying them.
+     *
+     * @pre
+     * - The passed variable must be in the set of the variables.
+     *
+     * @throw std::invalid_argument The precondition were not satisfied.
+     */
+    BodyRange bodyRange(const char& v) const;
+
     /**
      * @brief Get all the nullable variables.
      *
@@ -99,9 +234,16 @@ public:
      * of the form A -> ε, but doing so that the CFG still accepts the same
      * language with epsilon (empty string excluded).
      *
+     * @param mode How to eleminate them. EPSILON_BINARIZED introduces new
+     * variables, but the amount of production rules only grows
+     * polynomially.
+     *
+     * @throw std::runtime_error if there are no characters left for new
+     * variables.
+     *
      * @post The production rules doesn't contain any nullable symbols.
      */
-    void eleminateEpsilonProductions();
+    void eleminateEpsilonProductions(const EpsilonElimination& mode = EPSILON_SUBSETS);
 
     /**
      * @brief Get all the unit pairs of this CFG.
@@ -112,21 +254,34 @@ public:
      */
     std::set< std::pair<char, char> > units() const;
 
+    /**
+     * @brief Get all the unit pairs of this CFG, also if there are cycles of
+     * unit productions. The variables on a cycle (a strongly connected
+     * component of the unit productions) have the same unit pairs, so each
+     * component is handled once, in topological order.
+     *
+     * @return The set of all unit pairs.
+     */
+    std::set< std::pair<char, char> > unitClosure() const;
+
     /**
      * @brief Eleminate unit productions. That is, eleminate productions of
      * the form A -> B. But doing so that it does not affect the language of
      * this CFG.
      *
-     * @note The algorithm only works if there is no cycle of unit productions.
-     * That is, unit pairs of the form A -> B, B -> C and C -> A. If that's the
-     * case, an exception will be thrown.
+     * @note With UNITS_ACYCLIC the algorithm only works if there is no cycle
+     * of unit productions. That is, unit pairs of the form A -> B, B -> C and
+     * C -> A. If that's the case, an exception will be thrown.
      *
-     * @throw std::runtime_error When there are cyclic unit pairs.
+     * @param mode Which unit pairs to use.
+     *
+     * @throw std::runtime_error When there are cyclic unit pairs and the mode
+     * is UNITS_ACYCLIC.
      *
      * @post The CFG has only unit pairs of the form (A, A) for each A is a
      * variable.
      */
-    void eleminateUnitProductions();
+    void eleminateUnitProductions(const UnitElimination& mode = UNITS_ACYCLIC);
 
     /**
      * @brief Get all the generating symbols.
@@ -157,42 +312,107 @@ public:
      * converting to CNF (Chomsky Normal Form). Also: removes all variables
      * which don't have any production rules at all.
      *
+     * @param mode How to eleminate the epsilon productions.
+     * @param unitMode How to eleminate the unit productions, by default
+     * cycles of unit productions are allowed.
+     *
+     * @throw std::runtime_error When there are cyclic unit pairs and the
+     * unitMode is UNITS_ACYCLIC, or there are no characters left for new
+     * variables.
+     *
      * @post The production rules doesn't contain any nullable symbols.
      * @post The production rules doesn't contain any useless symbols.
      * @post The CFG has only unit pairs of the form (A, A) for each A is a
      * variable.
      */
-    void cleanUp();
+    void cleanUp(
+        const EpsilonElimination& mode = EPSILON_SUBSETS,
+        const UnitElimination& unitMode = UNITS_CONDENSED
+        );
 
     /*
      * @brief Get the terminals of the CFG.
      */
-    std::set<char> getTerminals(){
+    const std::set<char>& getTerminals() const {
     	return this->fTerminals;
     }
 
     /*
 	* @brief Get the variables of the CFG.
 	*/
-	std::set<char> getVariables(){
+	const std::set<char>& getVariables() const {
 		return this->fVariables;
 	}
 
 	 /*
 	 * @brief Get the productions of the CFG.
 	 */
-	std::multimap<char, SymbolString> getProductions(){
+	const std::multimap<char, SymbolString>& getProductions() const {
 		return this->fProductions;
 	}
 
 	 /*
 	 * @brief Get the start symbol of the CFG.
 	 */
-	char getStartsymbol(){
+	char getStartsymbol() const {
 		return this->fStartSymbol;
 	}
 
+    /**
+     * @brief Get the size of the grammar after each stage of cleanUp() (and
+     * of the conversion to CNF) and the time each stage took.
+     */
+    const GrammarStats& getStats() const {
+        return this->fStats;
+    }
+
 protected:
+    /**
+     * @brief Constructor, a grammar without symbols and production rules,
+     * for a derived class that fills them in itself with a grammar known to
+     * be valid (with the bodies of each head sorted and unique). Nothing is
+     * checked and no stage is recorded.
+     */
+    explicit CFG(const char& startsymbol);
+
+    /**
+     * @brief Replace the variables and production rules by those of a
+     * grammar converted from this one (with the same terminals). The
+     * variables without a name get the first characters that are not in
+     * use.
+     *
+     * @param grammar The converted grammar.
+     * @param keepVariables Whether to keep the variables without production
+     * rules.
+     *
+     * @return The character of each variable of the grammar, 0 for the ones
+     * left out.
+     *
+     * @throw std::runtime_error if there are no characters left for the new
+     * variables, use an IndexedGrammar for such grammars.
+     */
+    std::vector<char> setGrammar(const IndexedGrammar& grammar, const bool& keepVariables);
+
+    /**
+     * @brief Remove duplicate production rules and sort the bodies of each
+     * head, so that bodyRange() gives the same bodies as bodies(). Only the
+     * heads whose bodies aren't sorted and unique yet are rebuilt, for the
+     * others this is one pass over the production rules.
+     */
+    void uniqueProductions();
+
+    /**
+     * @brief Replace the production rules, the bodies of each head being
+     * sorted and unique already.
+     */
+    void setProductions(const std::map< char, std::set<SymbolString> >& productions);
+
+    /**
+     * @brief Add the current size of the grammar to the stats, as the result
+     * of a stage that started at begin.
+     */
+    void recordStage(const std::string& stage, const std::chrono::steady_clock::time_point& begin);
+
     /**
      * @brief The set of terminal symbols.
      */
@@ -210,6 +430,9 @@ protected:
 
     // the starting symbol
     char fStartSymbol;
+
+    // the stages so far
+    GrammarStats fStats;
 };
 
 #endif /* CFG_H_ */
@@ -20,6 +20,12 @@
  * By: Stijn Wouters.
  */
 #include "CNF.h"
+#include "CNFCache.h"
+#include "CYK.h"
+#include "IndexedGrammar.h"
+#include "TinyXML/tinyxml.h"
+#include <algorithm>
+#include <chrono>
 #include <map>
 #include <stdexcept>
 
@@ -28,105 +34,104 @@ CNF::CNF(
     const std::set<char>& variables,
     const std::multimap<char, SymbolString>& productions,
     const char& start
-    ) : CFG(terminals, variables, productions, start) {
-    // first thing to do is clean up grammar
-    this->cleanUp();
-
-    unsigned int size_before = fVariables.size();
-
-    // new variables, keep incrementing until the variable is not already
-    // in the set of variables
-    char c = 1;
-    while (fVariables.find(c) != fVariables.end()) { ++c; }
-
-    // first, elemeninate terminal symbols in bodies (of size > 1)
-    std::map<char, char> terms; // which terminals belong to which variable
-
-    // generate productions of the form A --> a for a is each terminal
-    for (const char& t : fTerminals) {
-        // introduce a new variable
-        fVariables.insert(c);
+    ) : CNF(terminals, variables, productions, start, ProductionWeights()) {
+}
 
-        fProductions.insert(std::pair<char, SymbolString>(c, SymbolString(1, t)));
+CNF::CNF(
+    const std::set<char>& terminals,
+    const std::set<char>& variables,
+    const std::multimap<char, SymbolString>& productions,
+    const char& start,
+    const ProductionWeights& weights,
+    const Binarization& binarization
+    ) : CFG(terminals, variables, productions, start), fWeighted(!weights.empty()) {
+    // clean up and convert on the integer symbols, the stages are recorded
+    // by the IndexedGrammar
+    IndexedGrammar grammar(*this, weights);
+    grammar.toCNF(EPSILON_SUBSETS, binarization);
+
+    const std::vector<char> names = this->setGrammar(grammar, false);
+    fStats = grammar.stats();
+
+    if (!fWeighted)
+        return;
+
+    for (std::size_t p = 0; p < grammar.productions(); ++p) {
+        SymbolString body;
+
+        for (unsigned int k = 0; k < grammar.bodySize(p); ++k) {
+            const Symbol& s = grammar.body(p)[k];
+            body += IndexedGrammar::isTerminal(s) ? IndexedGrammar::toTerminal(s) : names[IndexedGrammar::toIndex(s)];
+        } // end for
 
-        terms.insert(std::pair<char, char>(t, c));
+        const char head = names[IndexedGrammar::toIndex(grammar.head(p))];
+        fWeights[std::pair<char, SymbolString>(head, body)] = grammar.weight(p);
+    } // end for
+}
 
-        // don't forget to update the variable!
-        ++c;
-        while (fVariables.find(c) != fVariables.end()) { ++c; }
+CNF::CNF(const CNFCacheArrays& arrays) : CFG(arrays.start), fWeighted(arrays.weighted) {
+    // the symbols are sorted, so each one goes at the end
+    for (std::size_t t = 0; t < arrays.terminals; ++t) {
+        fTerminals.insert(fTerminals.end(), arrays.terminalSymbols[t]);
     } // end for
 
-    // now we can actually remove the terminals in the bodies of size > 1
-    std::multimap<char, SymbolString> newProductions;
+    for (std::size_t v = 0; v < arrays.variables; ++v) {
+        fVariables.insert(fVariables.end(), arrays.variableSymbols[v]);
+    } // end for
 
-    for (const char& v : fVariables) {
-        for (const SymbolString& body : this->bodies(v)) {
-            if (body.size() > 1) {
-                // replace all terminals by the corresponding variables
-                SymbolString newBody;
+    // the production rules are sorted on head and then on body, just as the
+    // keys of the weights
+    for (std::size_t p = 0; p < arrays.productions; ++p) {
+        const std::pair<char, SymbolString> rule(
+                        arrays.heads[p],
+                        SymbolString(arrays.bodies + arrays.offsets[p], arrays.bodies + arrays.offsets[p + 1])
+                        );
 
-                for (const char& s : body) {
-                    if (fTerminals.find(s) == fTerminals.end()) {
-                        // you may append variables
-                        newBody += s;
-                    } else {
-                        // replace terminal by the corresponding terminal
-                        newBody += terms.find(s)->second;
-                    } // end if-else
-                } // end for
+        fProductions.insert(fProductions.end(), rule);
 
-                newProductions.insert(std::pair<char, SymbolString>(v, newBody));
-            } else {
-                newProductions.insert(std::pair<char, SymbolString>(v, body));
-            } // end if-else
-        } // end for
+        if (fWeighted)
+            fWeights.insert(fWeights.end(), std::pair<std::pair<char, SymbolString>, double>(rule, arrays.weights[p]));
     } // end for
+}
 
-    fProductions = newProductions;
-
-    unsigned int size_after = fVariables.size();
+bool CNF::isWeighted() const {
+    return fWeighted;
+}
 
-    // keep going untill no new variables were introduced (indicating
-    // everything is now in Chomsky Normal Form)
-    while (size_before != size_after) {
-        size_before = fVariables.size();
+double CNF::weight(const char& head, const SymbolString& body) const {
+    auto it = fWeights.find(std::pair<char, SymbolString>(head, body));
 
-        // the new set of production rules
-        std::multimap<char, SymbolString> newProductions;
+    if (it == fWeights.end())
+        return 0;
 
-        for (const char& v : fVariables) {
-            for (const SymbolString& body : this->bodies(v)) {
-                if (body.size() <= 2) {
-                    // this rule is already in Chomsky Normal Form
-                    newProductions.insert(std::pair<char, SymbolString>(v, body));
-                } else {
-                    // e.g. ABCDE becomes AB and VCDE bodies
+    return it->second;
+}
 
-                    // introduce new variable
-                    fVariables.insert(c);
+bool CNF::CYK(const std::string& terminalstring) const {
+    return this->classicCYK<false>(terminalstring, NULL);
+}
 
-                    // add the rule V --> AB
-                    newProductions.insert(std::pair<char, SymbolString>(c, SymbolString(body.begin(), body.begin()+2)));
+bool CNF::CYK(const std::string& terminalstring, CYKStats& stats) const {
+    const auto begin = std::chrono::steady_clock::now();
 
-                    SymbolString newBody1(1, c);
-                    // append the rest of the original body (ABCDE) --> (VCDE)
-                    newBody1.append(body.begin()+2, body.end());
-                    newProductions.insert(std::pair<char, SymbolString>(v, newBody1));
+    stats.cells = 0;
+    stats.pairs = 0;
+    stats.maxPairs = 0;
+    stats.matches = 0;
+    stats.pairsPerLength.assign(terminalstring.size() + 1, 0);
+    stats.seconds = 0;
 
-                    // don't forget to update the variable!
-                    ++c;
-                    while (fVariables.find(c) != fVariables.end()) { ++c; }
-                } // end if-else
-            } // end for
-        } // end for
+    const bool accepted = this->classicCYK<true>(terminalstring, &stats);
 
-        fProductions = newProductions;
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    stats.seconds = elapsed.count();
 
-        size_after = fVariables.size();
-    } // end while
+    return accepted;
 }
 
-bool CNF::CYK(const std::string& terminalstring) const {
+template <bool Counted>
+bool CNF::classicCYK(const std::string& terminalstring, CYKStats* stats) const {
+
     // first, check whether the terminalstring is valid
     for (const char& t : terminalstring) {
         if (fTerminals.find(t) == fTerminals.end())
@@ -138,7 +143,7 @@ bool CNF::CYK(const std::string& terminalstring) const {
     std::multimap<SymbolString, char> inductiveProductions;
 
     for (const char& v : fVariables) {
-        for (const SymbolString& body : this->bodies(v)) {
+        for (const SymbolString& body : this->bodyRange(v)) {
             if (body.size() > 1) {
                 // inductive production rule
                 inductiveProductions.insert(std::pair<SymbolString, char>(body, v));
@@ -173,6 +178,8 @@ bool CNF::CYK(const std::string& terminalstring) const {
     while( !(i == 1 && j == terminalstring.size()+1) ) {
         // the set of variables producing this X(ij)
         std::set<char> vset;
+        unsigned long long pairs = 0;
+        unsigned long long matches = 0;
 
         for (unsigned int k = i; k < j; ++k) {
             for (const char& v0 : table.find(std::pair<int, int>(i, k))->second) {
@@ -181,15 +188,29 @@ bool CNF::CYK(const std::string& terminalstring) const {
                     body += std::string(1, v0);
                     body += std::string(1, v1);
 
+                    if (Counted)
+                        ++pairs;
+
                     // try to find variables producing sentential form v(0)v(1)
                     auto range = inductiveProductions.equal_range(body);
                     for (auto it = range.first; it != range.second; ++it) {
                         vset.insert(it->second);
                     } // end for
+
+                    if (Counted && range.first != range.second)
+                        ++matches;
                 } // end for
             } // end for
         } // end for
 
+        if (Counted) {
+            ++stats->cells;
+            stats->pairs += pairs;
+            stats->maxPairs = std::max(stats->maxPairs, pairs);
+            stats->pairsPerLength[j - i + 1] += pairs;
+            stats->matches += matches;
+        } // end if
+
         table.insert(std::pair<std::pair<int, int>, std::set<char>>(std::pair<int, int>(i, j), vset));
 
         // now iterate further, depending where you are now
@@ -207,3 +228,207 @@ bool CNF::CYK(const std::string& terminalstring) const {
     auto setit = (it->second).find(fStartSymbol);
     return (setit == (it->second).end()) ? false : true;
 }
+
+bool CNF::CYK(
+    const std::string& terminalstring,
+    const CYKEngine& engine,
+    const unsigned int& threads
+    ) const {
+    if (engine == CYK_CLASSIC)
+        return this->CYK(terminalstring);
+
+    const CYKGrammar grammar(*this);
+
+    if (engine == CYK_MATRIX)
+        return CYKMatrix(grammar, terminalstring).accepted();
+
+    if (engine == CYK_WAVEFRONT)
+        return CYKTable(grammar, terminalstring, CYKPool::shared(threads)).accepted();
+
+    return CYKTable(grammar, terminalstring).accepted();
+}
+
+std::vector<bool> CNF::CYK(
+    const std::vector<std::string>& terminalstrings,
+    const unsigned int& threads
+    ) const {
+    const CYKGrammar grammar(*this);
+
+    return batchCYK(grammar, terminalstrings, threads);
+}
+
+std::vector< std::pair<unsigned int, unsigned int> > CNF::acceptedSubstrings(
+    const std::string& terminalstring,
+    const bool& maximal
+    ) const {
+    const CYKGrammar grammar(*this);
+    const CYKMatrix matrix(grammar, terminalstring);
+
+    std::vector< std::pair<unsigned int, unsigned int> > substrings;
+
+    if (!grammar.hasStart())
+        return substrings;
+
+    const unsigned int n = terminalstring.size();
+
+    // the last position of the longest substring accepted so far
+    unsigned int reach = 0;
+
+    for (unsigned int i = 1; i <= n; ++i) {
+        if (!maximal) {
+            for (unsigned int j = i; j <= n; ++j) {
+                if (matrix.derives(grammar.start(), i, j - i + 1))
+                    substrings.push_back(std::pair<unsigned int, unsigned int>(i, j));
+            } // end for
+
+            continue;
+        } // end if
+
+        // only the longest one starting at i can be maximal, and only if
+        // it isn't part of one that starts earlier
+        for (unsigned int j = n; j > reach && j >= i; --j) {
+            if (matrix.derives(grammar.start(), i, j - i + 1)) {
+                substrings.push_back(std::pair<unsigned int, unsigned int>(i, j));
+                reach = j;
+                break;
+            } // end if
+        } // end for
+    } // end for
+
+    return substrings;
+}
+
+CNF generateCNF(const std::string& fileName) {
+    // start to parse
+    TiXmlDocument doc;
+    if (!doc.LoadFile(fileName.c_str()))
+        throw std::runtime_error("XML file does not exist");
+
+    TiXmlElement* root = doc.FirstChildElement();
+
+    if (root == NULL) {
+        doc.Clear();
+        throw std::runtime_error("No root element");
+    } // end if
+
+    std::string rootname = root->Value();
+    std::transform(rootname.begin(), rootname.end(), rootname.begin(), ::tolower);
+
+    if ( !( (rootname == "cfg") || (rootname == "cnf") ) ) {
+        doc.Clear();
+        throw std::runtime_error("Not a CFG or CNF XML file.");
+    } // end if
+
+    // ok, now ACTUALLY parse the stuffs
+    std::set<char> terminals;
+    std::set<char> variables;
+    std::multimap<char, SymbolString> productions;
+    ProductionWeights weights;
+    char start = 0;
+
+    for (TiXmlElement* el = root->FirstChildElement(); el != NULL; el = el->NextSiblingElement()) {
+        std::string elName = el->Value();
+        std::transform(elName.begin(), elName.end(), elName.begin(), ::tolower);
+
+        if (elName == "terminals") {
+            TiXmlNode* n = el->FirstChild();
+            TiXmlText* text = NULL;
+
+            if (n != NULL)
+                text = n->ToText();
+
+            if (text == NULL)
+                continue;
+
+            std::string terms = text->Value();
+            for (char t : terms) {
+                terminals.insert(t);
+            } // end for
+
+        } else if (elName == "variables") {
+            TiXmlNode* n = el->FirstChild();
+            TiXmlText* text = NULL;
+
+            if (n != NULL)
+                text = n->ToText();
+
+            if (text == NULL)
+                continue;
+
+            std::string vars = text->Value();
+            for (char v : vars) {
+                variables.insert(v);
+            } // end for
+
+        } else if (elName == "productions") {
+            for (TiXmlElement* rule = el->FirstChildElement(); rule != NULL; rule = rule->NextSiblingElement()) {
+                std::string ruleName = rule->Value();
+                std::transform(ruleName.begin(), ruleName.end(), ruleName.begin(), ::tolower);
+
+                if (ruleName == "rule") {
+                    char head = 0;
+                    double weight = 1;
+                    bool weighted = false;
+
+                    for (TiXmlAttribute* attr = rule->FirstAttribute(); attr != NULL; attr = attr->Next()) {
+                        std::string attrName = attr->Name();
+                        std::transform(attrName.begin(), attrName.end(), attrName.begin(), ::tolower);
+
+                        if (attrName == "head") {
+                            std::string headStr = attr->Value();
+
+                            if (headStr.size() == 1)
+                                head = headStr.front();
+                        } else if (attrName == "weight") {
+                            if (attr->QueryDoubleValue(&weight) != TIXML_SUCCESS)
+                                throw std::runtime_error("Invalid weight of a production rule.");
+
+                            weighted = true;
+                        } else {
+                            // ignore other information
+                        } // end if-else
+                    } // end for
+
+                    TiXmlNode* n = rule->FirstChild();
+                    TiXmlText* text = NULL;
+
+                    if (n != NULL)
+                        text = n->ToText();
+
+                    std::string body;
+
+                    if (text == NULL) {
+                        body = "";
+                    } else {
+                        body = text->Value();
+                    } // end if-else
+
+                    productions.insert(std::pair<char, SymbolString>(head, body));
+
+                    if (weighted)
+                        weights[std::pair<char, SymbolString>(head, body)] = weight;
+                } else  {
+                    // ignore other information
+                } // end if-else
+            } // end for
+        } else if (elName == "start") {
+            TiXmlNode* n = el->FirstChild();
+            TiXmlText* text = NULL;
+
+            if (n != NULL)
+                text = n->ToText();
+
+            if (text == NULL)
+                continue;
+
+            std::string symbol = text->Value();
+
+            if (symbol.size() == 1)
+                start = symbol.front();
+        } else {
+            // ignore node
+        } // end if-else
+    } // end for
+
+    return CNF(terminals, variables, productions, start, weights);
+}
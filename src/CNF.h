@@ -26,6 +26,50 @@
 #include "CFG.h"
 #include <set>
 #include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The weights of production rules (head, body), as probabilities.
+ * Rules that are not in the map have weight 1.
+ */
+typedef std::map<std::pair<char, SymbolString>, double> ProductionWeights;
+
+// the arrays of a CNF cache file, see CNFCache.h
+struct CNFCacheArrays;
+
+/**
+ * @brief The implementations of the CYK algorithm to choose from.
+ */
+enum CYKEngine {
+    CYK_CLASSIC,   // table of std::set's, see CNF::CYK(terminalstring)
+    CYK_BITSET,    // flat table of variable bitsets, see CYKTable
+    CYK_WAVEFRONT, // CYK_BITSET, filling each diagonal with multiple threads
+    CYK_MATRIX     // boolean matrix products on bit matrices, see CYKMatrix
+};
+
+/**
+ * @brief What the classic CYK algorithm did for a string, to see why a
+ * grammar is slow, see CNF::CYK().
+ */
+struct CYKStats {
+    // the cells of the substrings of at least two symbols
+    std::size_t cells;
+
+    // the pairs (B, C) of a variable B deriving the first part and C the
+    // second part of a substring that were looked up, over all cells and
+    // split points, the most for one cell and the ones that were the body
+    // of a production rule
+    unsigned long long pairs;
+    unsigned long long maxPairs;
+    unsigned long long matches;
+
+    // the pairs for all cells of substrings of each length
+    std::vector<unsigned long long> pairsPerLength;
+
+    double seconds;
+};
 
 /**
  * @brief The class CNF (Chomsky Normal Form), this is actually a CFG (Context
@@ -50,6 +94,10 @@ public:
      * terminals and variables.
      * @param start The start symbol.
      *
+     * @throw std::runtime_error if the CNF needs more variables than there
+     * are characters, use IndexedGrammar::toCNF() and CYKGrammar for such
+     * grammars.
+     *
      * @post
      * - The CFG methods will produce the same result as if it was already
      *   cleaned up without unwanted side-effects.
@@ -61,6 +109,52 @@ public:
         const char& start
         );
 
+    /**
+     * @brief Constructor, just as above but with weighted production rules.
+     * The weights are carried over to the production rules of the CNF, such
+     * that the best derivation of a string in the CNF has the weight of the
+     * best derivation of that string in the original CFG:
+     * - a rule that comes from leaving out nullable symbols gets the weight
+     *   of the best derivation of the empty string by these symbols,
+     * - a rule that replaces a chain of unit productions gets the weight of
+     *   the best chain,
+     * - the rules introduced for terminals and for splitting long bodies get
+     *   weight 1.
+     *
+     * @param terminals The set of terminal symbols.
+     * @param variables The set of non-terminal symbols.
+     * @param productions The set of production rules.
+     * @param start The start symbol.
+     * @param weights The weights of the production rules.
+     * @param binarization How to split long bodies, sharing prefixes needs
+     * less variables and rules.
+     *
+     * @throw std::invalid_argument if a weight is not positive or above 1.
+     * @throw std::runtime_error if the CNF needs more variables than there
+     * are characters.
+     */
+    CNF(
+        const std::set<char>& terminals,
+        const std::set<char>& variables,
+        const std::multimap<char, SymbolString>& productions,
+        const char& start,
+        const ProductionWeights& weights,
+        const Binarization& binarization = BINARIZE_FRESH
+        );
+
+    /**
+     * @brief Check whether the production rules were given weights.
+     */
+    bool isWeighted() const;
+
+    /**
+     * @brief Get the weight of a production rule of this CNF, in log-space.
+     *
+     * @return The natural logarithm of the weight, 0 if the CNF isn't
+     * weighted.
+     */
+    double weight(const char& head, const SymbolString& body) const;
+
     /**
      * @brief Check whether the terminalstring is in the language of this CNF
      * by using the CYK algorithm.
@@ -79,6 +173,110 @@ public:
      * terminal string (that is, not consisting of terminal symbols).
      */
     bool CYK(const std::string& terminalstring) const;
+
+    /**
+     * @brief Check whether the terminalstring is in the language of this CNF
+     * just as above, also counting the candidate pairs of each cell.
+     *
+     * @param terminalstring The string to be checked.
+     * @param stats What the algorithm did, overwritten.
+     *
+     * @throw std::invalid_argument if the string passed is not a valid
+     * terminal string (that is, not consisting of terminal symbols).
+     */
+    bool CYK(const std::string& terminalstring, CYKStats& stats) const;
+
+    /**
+     * @brief Check whether the terminalstring is in the language of this CNF
+     * by using the passed implementation of the CYK algorithm. All engines
+     * give the same answer, they only differ in speed.
+     *
+     * @param terminalstring The string to be checked whether this is in the
+     * language of the CFG.
+     * @param engine The implementation to be used.
+     * @param threads The amount of threads for CYK_WAVEFRONT, 0 means one
+     * for each hardware thread.
+     *
+     * @return True if the terminalstring is in the language of this CFG,
+     * false if not.
+     *
+     * @throw std::invalid_argument if the string passed is not a valid
+     * terminal string (that is, not consisting of terminal symbols).
+     */
+    bool CYK(
+        const std::string& terminalstring,
+        const CYKEngine& engine,
+        const unsigned int& threads = 0
+        ) const;
+
+    /**
+     * @brief Check for each string of a batch whether it is in the language
+     * of this CNF. The CNF is compiled only once for the whole batch, and
+     * the strings are checked in parallel (see batchCYK in CYK.h).
+     *
+     * @param terminalstrings The strings to be checked.
+     * @param threads The amount of threads, 0 means one for each hardware
+     * thread.
+     *
+     * @return For each string whether it is in the language of this CNF.
+     *
+     * @throw std::invalid_argument if one of the strings is not a valid
+     * terminal string.
+     */
+    std::vector<bool> CYK(
+        const std::vector<std::string>& terminalstrings,
+        const unsigned int& threads = 0
+        ) const;
+
+    /**
+     * @brief Get all the substrings of the terminalstring that are in the
+     * language of this CNF, using a single CYK table.
+     *
+     * @param terminalstring The string whose substrings are to be checked.
+     * @param maximal If true, only return the substrings that are not part
+     * of a longer accepted substring.
+     *
+     * @return The accepted substrings as pairs (i, j) of the first and the
+     * last position (1-based, as in the CYK table), sorted on i and then j.
+     *
+     * @throw std::invalid_argument if the string passed is not a valid
+     * terminal string (that is, not consisting of terminal symbols).
+     */
+    std::vector< std::pair<unsigned int, unsigned int> > acceptedSubstrings(
+        const std::string& terminalstring,
+        const bool& maximal = false
+        ) const;
+
+private:
+    // the grammar of the arrays of a cache file, as they are mapped in
+    // memory: it's already in Chomsky Normal Form with the bodies of each
+    // head sorted and unique, so nothing is checked or converted
+    explicit CNF(const CNFCacheArrays& arrays);
+
+    friend CNF loadCNF(const std::string& fileName, const unsigned long long& sourceHash);
+
+    // the classic CYK algorithm, only counting into stats if Counted (so the
+    // plain CYK(terminalstring) doesn't pay for it)
+    template <bool Counted>
+    bool classicCYK(const std::string& terminalstring, CYKStats* stats) const;
+
+    bool fWeighted;
+
+    // the log weights of the production rules, 0 if not in the map
+    std::map<std::pair<char, SymbolString>, double> fWeights;
 };
 
+/**
+ * @brief Read a CNF from a CFG or CNF XML file. A rule may have a weight
+ * attribute, if one of the rules has, the CNF is weighted.
+ *
+ * @param fileName Name of the XML file.
+ *
+ * @return The CNF.
+ *
+ * @throw std::runtime_error if the file can't be read or isn't a CFG or CNF
+ * XML file.
+ */
+CNF generateCNF(const std::string& fileName);
+
 #endif // H_CNF_H
@@ -0,0 +1,296 @@
+/* CNFCache
+ * Implementation of the binary cache files of converted CNF's.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "CNFCache.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CNF_CACHE_MMAP
+#endif
+
+namespace {
+
+// "CNFC", also tells whether the file was written with another byte order
+const std::uint32_t MAGIC = 0x434E4643;
+
+struct Header {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t hash;
+    std::uint32_t terminals;
+    std::uint32_t variables;
+    std::uint32_t productions;
+    std::uint32_t symbols;
+    char start;
+    std::uint8_t weighted;
+    char padding[6];
+};
+
+static_assert(sizeof(Header) == 40, "The header of a cache file must be 40 bytes.");
+
+/**
+ * @brief The contents of a file, mapped in memory if possible and read
+ * otherwise.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& fileName) : fData(NULL), fSize(0) {
+#ifdef CNF_CACHE_MMAP
+        const int fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd == -1)
+            throw std::runtime_error("Could not open " + fileName + ".");
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Could not open " + fileName + ".");
+        } // end if
+
+        fSize = info.st_size;
+
+        if (fSize != 0) {
+            void* data = ::mmap(NULL, fSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (data == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Could not map " + fileName + ".");
+            } // end if
+
+            fData = static_cast<const char*>(data);
+        } // end if
+
+        // the mapping stays valid after closing
+        ::close(fd);
+#else
+        std::ifstream file(fileName.c_str(), std::ios::binary);
+        if (!file)
+            throw std::runtime_error("Could not open " + fileName + ".");
+
+        fBuffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        fSize = fBuffer.size();
+        fData = fBuffer.empty() ? NULL : &fBuffer[0];
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef CNF_CACHE_MMAP
+        if (fData != NULL)
+            ::munmap(const_cast<char*>(fData), fSize);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const {
+        return fData;
+    }
+
+    std::size_t size() const {
+        return fSize;
+    }
+
+private:
+    const char* fData;
+    std::size_t fSize;
+
+#ifndef CNF_CACHE_MMAP
+    std::vector<char> fBuffer;
+#endif
+};
+
+/**
+ * @brief Gives the arrays of a cache file one after the other, checking
+ * that they are inside the file. The arrays are used where they are: the
+ * file starts at a page (or at memory from new when it's read), and each
+ * array is aligned as long as the ones before it are, since the header is
+ * 40 bytes and the weights and offsets come before the characters.
+ */
+class Reader {
+public:
+    Reader(const char* data, const std::size_t& size) : fData(data), fSize(size), fPosition(0) {
+    }
+
+    template <class T>
+    const T* next(const std::size_t& count) {
+        if (count > (fSize - fPosition) / sizeof(T))
+            throw std::runtime_error("Invalid CNF cache file.");
+
+        const T* array = reinterpret_cast<const T*>(fData + fPosition);
+        fPosition += count * sizeof(T);
+        return array;
+    }
+
+private:
+    const char* fData;
+    std::size_t fSize;
+    std::size_t fPosition;
+};
+
+template <class T>
+void write(std::ofstream& file, const std::vector<T>& values) {
+    if (!values.empty())
+        file.write(reinterpret_cast<const char*>(&values[0]), values.size() * sizeof(T));
+}
+
+} // end namespace
+
+unsigned long long hashFile(const std::string& fileName) {
+    const MappedFile file(fileName);
+
+    std::uint64_t hash = 14695981039346656037ULL;
+
+    for (std::size_t i = 0; i < file.size(); ++i) {
+        hash ^= static_cast<unsigned char>(file.data()[i]);
+        hash *= 1099511628211ULL;
+    } // end for
+
+    return hash;
+}
+
+void saveCNF(const CNF& cnf, const std::string& fileName, const unsigned long long& sourceHash) {
+    const std::set<char>& terminals = cnf.getTerminals();
+    const std::set<char>& variables = cnf.getVariables();
+    const std::multimap<char, SymbolString>& productions = cnf.getProductions();
+
+    std::vector<double> weights;
+    std::vector<std::uint32_t> offsets(1, 0);
+    std::vector<char> heads;
+    std::vector<char> bodies;
+
+    for (const auto& p : productions) {
+        if (cnf.isWeighted())
+            weights.push_back(cnf.weight(p.first, p.second));
+
+        heads.push_back(p.first);
+        bodies.insert(bodies.end(), p.second.begin(), p.second.end());
+        offsets.push_back(bodies.size());
+    } // end for
+
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    header.magic = MAGIC;
+    header.version = CNF_CACHE_VERSION;
+    header.hash = sourceHash;
+    header.terminals = terminals.size();
+    header.variables = variables.size();
+    header.productions = productions.size();
+    header.symbols = bodies.size();
+    header.start = cnf.getStartsymbol();
+    header.weighted = cnf.isWeighted();
+
+    // write to another file first, so a file that is read at the same time
+    // is never half written
+    const std::string temporary = fileName + ".tmp";
+
+    {
+        std::ofstream file(temporary.c_str(), std::ios::binary | std::ios::trunc);
+        if (!file)
+            throw std::runtime_error("Could not write " + fileName + ".");
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        write(file, weights);
+        write(file, offsets);
+        write(file, heads);
+        write(file, std::vector<char>(terminals.begin(), terminals.end()));
+        write(file, std::vector<char>(variables.begin(), variables.end()));
+        write(file, bodies);
+
+        if (!file) {
+            file.close();
+            std::remove(temporary.c_str());
+            throw std::runtime_error("Could not write " + fileName + ".");
+        } // end if
+    }
+
+    if (std::rename(temporary.c_str(), fileName.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Could not write " + fileName + ".");
+    } // end if
+}
+
+CNF loadCNF(const std::string& fileName, const unsigned long long& sourceHash) {
+    const MappedFile file(fileName);
+    Reader reader(file.data(), file.size());
+
+    const Header& header = *reader.next<Header>(1);
+
+    if (header.magic != MAGIC)
+        throw std::runtime_error("Not a CNF cache file.");
+
+    if (header.version != CNF_CACHE_VERSION)
+        throw std::runtime_error("CNF cache file of another version.");
+
+    if (sourceHash != 0 && header.hash != sourceHash)
+        throw std::runtime_error("CNF cache file of another source.");
+
+    CNFCacheArrays arrays;
+    arrays.start = header.start;
+    arrays.weighted = header.weighted;
+    arrays.terminals = header.terminals;
+    arrays.variables = header.variables;
+    arrays.productions = header.productions;
+
+    arrays.weights = reader.next<double>(header.weighted ? header.productions : 0);
+    arrays.offsets = reader.next<std::uint32_t>(header.productions + 1ULL);
+    arrays.heads = reader.next<char>(header.productions);
+    arrays.terminalSymbols = reader.next<char>(header.terminals);
+    arrays.variableSymbols = reader.next<char>(header.variables);
+    arrays.bodies = reader.next<char>(header.symbols);
+
+    // the bodies have to be inside the file as well
+    for (std::size_t p = 0; p < arrays.productions; ++p) {
+        if (arrays.offsets[p] > arrays.offsets[p + 1] || arrays.offsets[p + 1] > header.symbols)
+            throw std::runtime_error("Invalid CNF cache file.");
+    } // end for
+
+    return CNF(arrays);
+}
+
+CNF cachedCNF(const std::string& fileName, const std::string& cacheFile) {
+    const std::string cache = cacheFile.empty() ? fileName + ".cnf" : cacheFile;
+    const unsigned long long hash = hashFile(fileName);
+
+    try {
+        return loadCNF(cache, hash);
+    } catch (const std::runtime_error& e) {
+        // no (valid) cache file, convert the XML file
+    } // end try-catch
+
+    const CNF cnf = generateCNF(fileName);
+
+    try {
+        saveCNF(cnf, cache, hash);
+    } catch (const std::runtime_error& e) {
+        // the cache is only there to speed things up
+    } // end try-catch
+
+    return cnf;
+}
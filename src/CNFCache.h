@@ -0,0 +1,116 @@
+/* CNFCache
+ * Binary cache files of converted CNF's, so the XML file doesn't have to be
+ * parsed and converted again on every run.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_CNFCACHE_H
+#define H_CNFCACHE_H
+
+#include "CNF.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief The version of the cache file format. Files of another version are
+ * never read, so change it whenever the format or the conversion to CNF
+ * changes.
+ *
+ * The format (in the byte order of the machine that wrote it) is a header
+ * followed by flat arrays, so the file can be used as it's mapped in memory:
+ * - the header: magic number, version, hash of the source, the amounts of
+ *   terminals, variables, production rules and body symbols, the start
+ *   symbol and whether the CNF is weighted (40 bytes),
+ * - the log weight of each production rule (doubles, only if weighted),
+ * - the offset of each body in the body symbols, one more than there are
+ *   production rules (32 bit),
+ * - the head of each production rule, the terminals, the variables and the
+ *   body symbols (characters).
+ */
+const unsigned int CNF_CACHE_VERSION = 1;
+
+/**
+ * @brief The arrays of a cache file, pointing into the file as it's mapped
+ * in memory, see loadCNF().
+ */
+struct CNFCacheArrays {
+    char start;
+    bool weighted;
+
+    std::size_t terminals;
+    std::size_t variables;
+    std::size_t productions;
+
+    const double* weights;     // one for each production rule, if weighted
+    const std::uint32_t* offsets; // one more than there are production rules
+    const char* heads;
+    const char* terminalSymbols;
+    const char* variableSymbols;
+    const char* bodies;
+};
+
+/**
+ * @brief Get the 64 bit FNV-1a hash of the contents of a file.
+ *
+ * @throw std::runtime_error if the file can't be read.
+ */
+unsigned long long hashFile(const std::string& fileName);
+
+/**
+ * @brief Write a CNF to a cache file.
+ *
+ * @param cnf The CNF.
+ * @param fileName Name of the cache file.
+ * @param sourceHash The hash of the file the CNF was read from.
+ *
+ * @throw std::runtime_error if the file can't be written.
+ */
+void saveCNF(const CNF& cnf, const std::string& fileName, const unsigned long long& sourceHash = 0);
+
+/**
+ * @brief Read a CNF from a cache file, without converting it again. The file
+ * is mapped in memory where possible, and the CNF is filled in straight from
+ * the mapped arrays: once the magic number, version and hash match, the
+ * arrays are trusted to be a valid CNF with sorted and unique bodies, only
+ * their bounds are checked.
+ *
+ * @param fileName Name of the cache file.
+ * @param sourceHash The hash the cache file must have been written with, 0
+ * to accept any hash.
+ *
+ * @throw std::runtime_error if the file can't be read, has another version
+ * or hash, or isn't a valid cache file.
+ */
+CNF loadCNF(const std::string& fileName, const unsigned long long& sourceHash = 0);
+
+/**
+ * @brief Read a CNF from a CFG or CNF XML file just as generateCNF(), but
+ * through a cache file: if the cache file was written for the same contents
+ * of the XML file, the CNF is read from it, else the XML file is converted
+ * and the cache file (re)written.
+ *
+ * @param fileName Name of the XML file.
+ * @param cacheFile Name of the cache file, by default the name of the XML
+ * file followed by ".cnf". A cache file that can't be written is ignored.
+ *
+ * @throw std::runtime_error if the XML file can't be read or isn't a CFG or
+ * CNF XML file.
+ */
+CNF cachedCNF(const std::string& fileName, const std::string& cacheFile = "");
+
+#endif // H_CNFCACHE_H
@@ -0,0 +1,1207 @@
+/* CYK
+ * Interface definition of the table based CYK engines for a CNF.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "CYK.h"
+#include "CNF.h"
+#include "IndexedGrammar.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <condition_variable>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+// the amount of bits in one word of a bitset
+const unsigned int BITS = 64;
+
+inline bool test(const CYKWord* set, const unsigned int& id) {
+    return (set[id / BITS] >> (id % BITS)) & 1;
+}
+
+inline void insert(CYKWord* set, const unsigned int& id) {
+    set[id / BITS] |= CYKWord(1) << (id % BITS);
+}
+
+/**
+ * @brief Lets a fixed amount of threads wait for each other.
+ */
+class Barrier {
+public:
+    explicit Barrier(const unsigned int& threads)
+        : fThreads(threads), fWaiting(0), fGeneration(0) {}
+
+    // block until all threads have called wait()
+    void wait() {
+        std::unique_lock<std::mutex> lock(fMutex);
+        const unsigned int generation = fGeneration;
+
+        if (++fWaiting == fThreads) {
+            // the last one releases all the others
+            fWaiting = 0;
+            ++fGeneration;
+            fCondition.notify_all();
+        } else {
+            fCondition.wait(lock, [&]() { return generation != fGeneration; });
+        } // end if-else
+    }
+
+private:
+    std::mutex fMutex;
+    std::condition_variable fCondition;
+    const unsigned int fThreads;
+    unsigned int fWaiting;
+    unsigned int fGeneration;
+};
+
+/**
+ * @brief Rebuild a derivation tree from back-pointers: 0 for A --> a,
+ * (rule + 1) << 32 | m for A --> BC with B deriving the first m terminals.
+ *
+ * @param back Gives the back-pointer of (id, i, l).
+ */
+template <class Back>
+CYKTree rebuild(
+    const CYKGrammar& grammar,
+    const std::string& terminalstring,
+    const unsigned int& id,
+    const unsigned int& i,
+    const unsigned int& l,
+    Back back
+    ) {
+    CYKTree tree;
+
+    // the id of the variable of each node, names need not be unique
+    std::vector<unsigned int> ids(1, id);
+
+    CYKNode root = {grammar.variable(id), i, l, -1, -1, 0};
+    tree.push_back(root);
+
+    // expand the nodes in the order they were added
+    for (std::size_t n = 0; n < tree.size(); ++n) {
+        const unsigned int start = tree[n].start;
+        const unsigned int length = tree[n].length;
+
+        if (length == 1) {
+            tree[n].terminal = terminalstring.at(start - 1);
+            continue;
+        } // end if
+
+        const CYKWord pointer = back(ids[n], start, length);
+        const CYKGrammar::BinaryRule& rule = grammar.binaryRules().at((pointer >> 32) - 1);
+        const unsigned int m = pointer & 0xffffffff;
+
+        CYKNode left = {grammar.variable(rule.left), start, m, -1, -1, 0};
+        CYKNode right = {grammar.variable(rule.right), start + m, length - m, -1, -1, 0};
+
+        tree[n].left = tree.size();
+        tree.push_back(left);
+        ids.push_back(rule.left);
+        tree[n].right = tree.size();
+        tree.push_back(right);
+        ids.push_back(rule.right);
+    } // end for
+
+    return tree;
+}
+
+// log(exp(a) + exp(b)) without leaving log-space
+inline double logAdd(const double& a, const double& b) {
+    const double hi = std::max(a, b);
+    const double lo = std::min(a, b);
+
+    if (lo == -std::numeric_limits<double>::infinity())
+        return hi;
+
+    return hi + std::log1p(std::exp(lo - hi));
+}
+
+} // end namespace
+
+CYKGrammar::CYKGrammar(const CNF& cnf) : CYKGrammar(IndexedGrammar(cnf)) {
+}
+
+CYKGrammar::CYKGrammar(const IndexedGrammar& grammar)
+    : fIds(256, -1), fTerminals(256, -1), fWords(0), fStart(-1) {
+    if (!grammar.isCNF())
+        throw std::invalid_argument("The grammar is not in Chomsky Normal Form.");
+
+    // the id of each variable of the grammar, -1 if it has no rules
+    std::vector<int> ids(grammar.variables(), -1);
+
+    for (std::size_t p = 0; p < grammar.productions(); ++p) {
+        ids.at(IndexedGrammar::toIndex(grammar.head(p))) = 0;
+    } // end for
+
+    // give each variable with production rules a dense id
+    for (unsigned int v = 0; v < grammar.variables(); ++v) {
+        if (ids[v] < 0)
+            continue;
+
+        const char name = grammar.name(IndexedGrammar::variable(v));
+
+        ids[v] = fVariables.size();
+        fVariables.push_back(name);
+
+        if (fIds.at(static_cast<unsigned char>(name)) < 0)
+            fIds.at(static_cast<unsigned char>(name)) = ids[v];
+    } // end for
+
+    fWords = (fVariables.size() + BITS - 1) / BITS;
+
+    if (grammar.hasStart())
+        fStart = ids.at(IndexedGrammar::toIndex(grammar.start()));
+
+    // one (possibly empty) bitset and row of weights for each terminal
+    int index = 0;
+    for (unsigned int t = 0; t < 256; ++t) {
+        if (!grammar.hasTerminal(t))
+            continue;
+
+        fTerminals.at(t) = index++;
+        fMasks.resize(fMasks.size() + fWords, 0);
+    } // end for
+
+    fTerminalWeights.assign(index * fVariables.size(), -std::numeric_limits<double>::infinity());
+
+    for (std::size_t p = 0; p < grammar.productions(); ++p) {
+        const unsigned int head = ids.at(IndexedGrammar::toIndex(grammar.head(p)));
+        const Symbol* body = grammar.body(p);
+
+        if (grammar.bodySize(p) == 1) {
+            // base production rule A --> a
+            const int t = fTerminals.at(body[0]);
+
+            insert(&fMasks.at(t * fWords), head);
+            fTerminalWeights.at(t * fVariables.size() + head) = grammar.weight(p);
+        } else {
+            // inductive production rule A --> BC
+            const int left = ids.at(IndexedGrammar::toIndex(body[0]));
+            const int right = ids.at(IndexedGrammar::toIndex(body[1]));
+
+            // B or C can't derive anything, so neither does this rule
+            if (left < 0 || right < 0)
+                continue;
+
+            BinaryRule rule = {head, unsigned(left), unsigned(right), grammar.weight(p)};
+            fBinaryRules.push_back(rule);
+        } // end if-else
+    } // end for
+
+    // group the rules A --> BC on B, then on C
+    std::vector<unsigned int> order(fBinaryRules.size());
+
+    for (std::size_t r = 0; r < order.size(); ++r) {
+        order[r] = r;
+    } // end for
+
+    std::sort(order.begin(), order.end(), [this](const unsigned int& i, const unsigned int& j) {
+        const BinaryRule& x = fBinaryRules[i];
+        const BinaryRule& y = fBinaryRules[j];
+
+        if (x.left != y.left)
+            return x.left < y.left;
+
+        if (x.right != y.right)
+            return x.right < y.right;
+
+        if (x.head != y.head)
+            return x.head < y.head;
+
+        return i < j;
+    });
+
+    fPairs.assign(fVariables.size() + 1, 0);
+
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        const BinaryRule& rule = fBinaryRules[order[k]];
+        const BinaryRule* previous = k > 0 ? &fBinaryRules[order[k-1]] : nullptr;
+        const bool same = previous != nullptr && rule.left == previous->left && rule.right == previous->right;
+
+        if (!same) {
+            ++fPairs[rule.left + 1];
+            fRights.push_back(rule.right);
+            fFirstHeads.push_back(fHeads.size());
+            fFirstIndices.push_back(fIndices.size());
+        } // end if
+
+        if (!same || rule.head != previous->head)
+            fHeads.push_back(rule.head);
+
+        fIndices.push_back(order[k]);
+    } // end for
+
+    fFirstHeads.push_back(fHeads.size());
+    fFirstIndices.push_back(fIndices.size());
+
+    for (std::size_t v = 1; v < fPairs.size(); ++v) {
+        fPairs[v] += fPairs[v-1];
+    } // end for
+}
+
+unsigned int CYKGrammar::size() const {
+    return fVariables.size();
+}
+
+unsigned int CYKGrammar::words() const {
+    return fWords;
+}
+
+bool CYKGrammar::hasStart() const {
+    return fStart >= 0;
+}
+
+unsigned int CYKGrammar::start() const {
+    return fStart;
+}
+
+int CYKGrammar::id(const char& v) const {
+    return fIds.at(static_cast<unsigned char>(v));
+}
+
+char CYKGrammar::variable(const unsigned int& id) const {
+    return fVariables.at(id);
+}
+
+bool CYKGrammar::isTerminal(const char& t) const {
+    return fTerminals.at(static_cast<unsigned char>(t)) >= 0;
+}
+
+const CYKWord* CYKGrammar::terminal(const char& t) const {
+    return fMasks.data() + fTerminals.at(static_cast<unsigned char>(t)) * fWords;
+}
+
+double CYKGrammar::weight(const unsigned int& id, const char& t) const {
+    return fTerminalWeights.at(fTerminals.at(static_cast<unsigned char>(t)) * fVariables.size() + id);
+}
+
+const std::vector<CYKGrammar::BinaryRule>& CYKGrammar::binaryRules() const {
+    return fBinaryRules;
+}
+
+std::pair<const unsigned int*, const unsigned int*> CYKGrammar::heads(
+    const unsigned int& left,
+    const unsigned int& right
+    ) const {
+    const unsigned int* first = fRights.data() + fPairs.at(left);
+    const unsigned int* last = fRights.data() + fPairs.at(left + 1);
+    const unsigned int* it = std::lower_bound(first, last, right);
+
+    if (it == last || *it != right)
+        return std::pair<const unsigned int*, const unsigned int*>(nullptr, nullptr);
+
+    const std::size_t k = it - fRights.data();
+
+    return std::pair<const unsigned int*, const unsigned int*>(
+                fHeads.data() + fFirstHeads[k],
+                fHeads.data() + fFirstHeads[k + 1]
+                );
+}
+
+void CYKGrammar::combine(const CYKWord* left, const CYKWord* right, CYKWord* out) const {
+    for (unsigned int w = 0; w < fWords; ++w) {
+        CYKWord bits = left[w];
+
+        // iterate over each variable B in the left set
+        while (bits != 0) {
+            const unsigned int b = w * BITS + __builtin_ctzll(bits);
+            bits &= bits - 1;
+
+            // and each production rule A --> BC whose C is in the right set
+            for (std::size_t k = fPairs[b]; k < fPairs[b + 1]; ++k) {
+                if (!test(right, fRights[k]))
+                    continue;
+
+                for (std::size_t h = fFirstHeads[k]; h < fFirstHeads[k + 1]; ++h) {
+                    insert(out, fHeads[h]);
+                } // end for
+            } // end for
+        } // end while
+    } // end for
+}
+
+void CYKGrammar::matches(const CYKWord* left, const CYKWord* right, std::vector<unsigned int>& rules) const {
+    for (unsigned int w = 0; w < fWords; ++w) {
+        CYKWord bits = left[w];
+
+        while (bits != 0) {
+            const unsigned int b = w * BITS + __builtin_ctzll(bits);
+            bits &= bits - 1;
+
+            for (std::size_t k = fPairs[b]; k < fPairs[b + 1]; ++k) {
+                if (!test(right, fRights[k]))
+                    continue;
+
+                rules.insert(rules.end(), fIndices.begin() + fFirstIndices[k], fIndices.begin() + fFirstIndices[k + 1]);
+            } // end for
+        } // end while
+    } // end for
+}
+
+void CYKGrammar::validate(const std::string& terminalstring) const {
+    for (const char& t : terminalstring) {
+        if (!this->isTerminal(t))
+            throw std::invalid_argument("Invalid terminal string.");
+    } // end for
+}
+
+CYKPool::CYKPool(const unsigned int& threads)
+    : fTask(nullptr), fGeneration(0), fBusy(0), fStop(false) {
+    unsigned int t = threads;
+    if (t == 0)
+        t = std::max(1u, std::thread::hardware_concurrency());
+
+    // the calling thread is thread 0
+    for (unsigned int i = 1; i < t; ++i) {
+        fThreads.push_back(std::thread(&CYKPool::work, this, i));
+    } // end for
+}
+
+CYKPool::~CYKPool() {
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fStop = true;
+    }
+
+    fStart.notify_all();
+
+    for (std::thread& t : fThreads) {
+        t.join();
+    } // end for
+}
+
+unsigned int CYKPool::size() const {
+    return fThreads.size() + 1;
+}
+
+void CYKPool::run(const std::function<void(const unsigned int&)>& task) {
+    std::lock_guard<std::mutex> running(fRun);
+
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fTask = &task;
+        fBusy = fThreads.size();
+        ++fGeneration;
+    }
+
+    fStart.notify_all();
+
+    task(0);
+
+    std::unique_lock<std::mutex> lock(fMutex);
+    fDone.wait(lock, [&]() { return fBusy == 0; });
+    fTask = nullptr;
+}
+
+CYKPool& CYKPool::shared(const unsigned int& threads) {
+    static std::mutex mutex;
+    static std::map<unsigned int, std::unique_ptr<CYKPool>> pools;
+
+    unsigned int t = threads;
+    if (t == 0)
+        t = std::max(1u, std::thread::hardware_concurrency());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<CYKPool>& pool = pools[t];
+
+    if (!pool)
+        pool.reset(new CYKPool(t));
+
+    return *pool;
+}
+
+void CYKPool::work(const unsigned int& t) {
+    unsigned long generation = 0;
+
+    while (true) {
+        const std::function<void(const unsigned int&)>* task;
+
+        {
+            std::unique_lock<std::mutex> lock(fMutex);
+            fStart.wait(lock, [&]() { return fStop || fGeneration != generation; });
+
+            if (fStop)
+                return;
+
+            generation = fGeneration;
+            task = fTask;
+        }
+
+        (*task)(t);
+
+        std::lock_guard<std::mutex> lock(fMutex);
+        if (--fBusy == 0)
+            fDone.notify_one();
+    } // end while
+}
+
+CYKTable::CYKTable(
+    const CYKGrammar& grammar,
+    const std::string& terminalstring,
+    const unsigned int& threads
+    ) : fGrammar(grammar), fLength(terminalstring.size()) {
+    this->initialize(terminalstring);
+
+    if (threads > 1) {
+        this->wavefront(CYKPool::shared(threads));
+        return;
+    } // end if
+
+    // inductive part, diagonal by diagonal
+    for (unsigned int l = 2; l <= fLength; ++l) {
+        this->fill(l, 1, fLength - l + 2);
+    } // end for
+}
+
+CYKTable::CYKTable(const CYKGrammar& grammar, const std::string& terminalstring, CYKPool& pool)
+    : fGrammar(grammar), fLength(terminalstring.size()) {
+    this->initialize(terminalstring);
+    this->wavefront(pool);
+}
+
+unsigned int CYKTable::length() const {
+    return fLength;
+}
+
+const CYKWord* CYKTable::cell(const unsigned int& i, const unsigned int& l) const {
+    return fCells.data() + this->offset(i, l);
+}
+
+bool CYKTable::derives(const unsigned int& id, const unsigned int& i, const unsigned int& l) const {
+    return test(this->cell(i, l), id);
+}
+
+bool CYKTable::accepted() const {
+    if (fLength == 0 || !fGrammar.hasStart())
+        return false;
+
+    return this->derives(fGrammar.start(), 1, fLength);
+}
+
+std::size_t CYKTable::offset(const unsigned int& i, const unsigned int& l) const {
+    // all the diagonals of length < l come first, diagonal m has
+    // (length - m + 1) cells
+    const std::size_t before = std::size_t(l - 1) * (fLength + 1) - std::size_t(l - 1) * l / 2;
+
+    return (before + i - 1) * fGrammar.words();
+}
+
+void CYKTable::initialize(const std::string& terminalstring) {
+    fGrammar.validate(terminalstring);
+
+    const unsigned int words = fGrammar.words();
+    fCells.assign(std::size_t(fLength) * (fLength + 1) / 2 * words, 0);
+
+    // base case: the substrings of length 1
+    for (unsigned int i = 1; i <= fLength; ++i) {
+        const CYKWord* t = fGrammar.terminal(terminalstring.at(i-1));
+        std::copy(t, t + words, fCells.begin() + this->offset(i, 1));
+    } // end for
+}
+
+void CYKTable::wavefront(CYKPool& pool) {
+    const unsigned int threads = pool.size();
+
+    // the diagonals with at least a cell for each thread go in parallel,
+    // for the others (the top of the table) the barrier costs more than it
+    // saves
+    unsigned int parallel = 1;
+    if (fLength >= threads)
+        parallel = fLength - threads + 1;
+
+    if (threads > 1 && parallel >= 2) {
+        // the wavefront: every thread fills an equal share of each diagonal
+        Barrier barrier(threads);
+
+        pool.run([&](const unsigned int& t) {
+            for (unsigned int l = 2; l <= parallel; ++l) {
+                const unsigned int cells = fLength - l + 1;
+
+                this->fill(l, 1 + cells * t / threads, 1 + cells * (t + 1) / threads);
+
+                // the next diagonal needs all cells of this one
+                barrier.wait();
+            } // end for
+        });
+    } else {
+        parallel = 1;
+    } // end if-else
+
+    for (unsigned int l = parallel + 1; l <= fLength; ++l) {
+        this->fill(l, 1, fLength - l + 2);
+    } // end for
+}
+
+void CYKTable::fill(const unsigned int& l, const unsigned int& first, const unsigned int& last) {
+    // X(i, l) is built from X(i, m) and X(i+m, l-m)
+    for (unsigned int i = first; i < last; ++i) {
+        CYKWord* out = fCells.data() + this->offset(i, l);
+
+        for (unsigned int m = 1; m < l; ++m) {
+            fGrammar.combine(this->cell(i, m), this->cell(i+m, l-m), out);
+        } // end for
+    } // end for
+}
+
+CYKMatrix::CYKMatrix(const CYKGrammar& grammar)
+    : fGrammar(grammar), fLength(0), fWords(1) {
+}
+
+CYKMatrix::CYKMatrix(const CYKGrammar& grammar, const std::string& terminalstring)
+    : fGrammar(grammar), fLength(0), fWords(1) {
+    this->parse(terminalstring);
+}
+
+void CYKMatrix::parse(const std::string& terminalstring) {
+    fGrammar.validate(terminalstring);
+
+    fLength = terminalstring.size();
+    fWords = (fLength + BITS) / BITS;
+
+    const unsigned int size = fGrammar.size();
+    const auto& rules = fGrammar.binaryRules();
+
+    // assign() keeps the memory of the previous string
+    fRows.assign(std::size_t(fLength + 1) * fWords * size, 0);
+    fAll.assign(fGrammar.words(), ~CYKWord(0));
+    fLeft.resize(fGrammar.words());
+
+    // base case: the substrings of length 1
+    for (unsigned int i = 0; i < fLength; ++i) {
+        const CYKWord* t = fGrammar.terminal(terminalstring.at(i));
+
+        for (unsigned int a = 0; a < size; ++a) {
+            if (test(t, a))
+                ::insert(this->row(a, i), i + 1);
+        } // end for
+    } // end for
+
+    // inductive part, row by row from the last one: row i of M(A) is the
+    // OR of the rows k of M(C) with M(B)[i][k] set, for all rules A --> BC.
+    // Those rows k > i are done, and going over k from left to right, bit k
+    // of row i is done before it is needed.
+    for (unsigned int i = fLength; i-- > 0;) {
+        for (unsigned int k = i + 1; k < fLength; ++k) {
+            // the variables B deriving the substring from i up to k
+            std::fill(fLeft.begin(), fLeft.end(), 0);
+
+            for (unsigned int b = 0; b < size; ++b) {
+                if (test(this->row(b, i), k))
+                    ::insert(fLeft.data(), b);
+            } // end for
+
+            fMatches.clear();
+            fGrammar.matches(fLeft.data(), fAll.data(), fMatches);
+
+            // row k only has bits j > k
+            const unsigned int first = (k + 1) / BITS;
+
+            for (const unsigned int& r : fMatches) {
+                CYKWord* out = this->row(rules[r].head, i);
+                const CYKWord* in = this->row(rules[r].right, k);
+
+                for (unsigned int w = first; w < fWords; ++w) {
+                    out[w] |= in[w];
+                } // end for
+            } // end for
+        } // end for
+    } // end for
+}
+
+unsigned int CYKMatrix::length() const {
+    return fLength;
+}
+
+bool CYKMatrix::derives(const unsigned int& id, const unsigned int& i, const unsigned int& l) const {
+    return test(fRows.data() + (std::size_t(id) * (fLength + 1) + i - 1) * fWords, i - 1 + l);
+}
+
+bool CYKMatrix::accepted() const {
+    if (fLength == 0 || !fGrammar.hasStart())
+        return false;
+
+    return this->derives(fGrammar.start(), 1, fLength);
+}
+
+CYKWord* CYKMatrix::row(const unsigned int& id, const unsigned int& i) {
+    return fRows.data() + (std::size_t(id) * (fLength + 1) + i) * fWords;
+}
+
+CYKScanner::CYKScanner(const CYKGrammar& grammar, const unsigned int& span)
+    : fGrammar(grammar), fSpan(span), fPosition(0) {
+    if (span == 0)
+        throw std::invalid_argument("The span should be at least 1.");
+
+    // the positions of a row and a column are both within the last span + 1
+    // positions, so they don't overlap in the ring
+    fRing = (span + BITS) / BITS * BITS;
+    fWords = fRing / BITS;
+
+    fRows.assign(std::size_t(fGrammar.size()) * fSpan * fWords, 0);
+    fColumns.assign(std::size_t(fGrammar.size()) * fWords, 0);
+}
+
+std::vector<CYKScanner::Window> CYKScanner::push(const char& terminal) {
+    if (!fGrammar.isTerminal(terminal))
+        throw std::invalid_argument("Invalid terminal string.");
+
+    const unsigned long j = ++fPosition;
+
+    // forget about the substrings that started span positions ago
+    for (unsigned int a = 0; a < fGrammar.size(); ++a) {
+        std::fill(this->row(a, j), this->row(a, j) + fWords, 0);
+        std::fill(this->column(a), this->column(a) + fWords, 0);
+    } // end for
+
+    // positions in the ring: a row has bit e set iff the variable derives
+    // the substring from start to e, a column has bit e set iff the variable
+    // derives the substring from e + 1 to j
+    const unsigned int end = j % fRing;
+
+    // base case: the substring of length 1
+    const CYKWord* t = fGrammar.terminal(terminal);
+    for (unsigned int a = 0; a < fGrammar.size(); ++a) {
+        if (!test(t, a))
+            continue;
+
+        insert(this->row(a, j), end);
+        insert(this->column(a), (j - 1) % fRing);
+    } // end for
+
+    // inductive part: the longer substrings ending at j, shortest first
+    for (unsigned long l = 2; l <= fSpan && l <= j; ++l) {
+        const unsigned long start = j - l + 1;
+
+        // the words holding the split points start <= e < j, possibly
+        // wrapping around (all the other bits are zero anyway)
+        const unsigned int first = (start % fRing) / BITS;
+        const unsigned int last = ((j - 1) % fRing) / BITS;
+
+        unsigned int words = (last + fWords - first) % fWords + 1;
+        if (first == last && start % fRing > (j - 1) % fRing)
+            words = fWords;
+
+        for (const CYKGrammar::BinaryRule& rule : fGrammar.binaryRules()) {
+            CYKWord* head = this->row(rule.head, start);
+
+            if (test(head, end))
+                continue;
+
+            const CYKWord* left = this->row(rule.left, start);
+            const CYKWord* right = this->column(rule.right);
+
+            CYKWord any = 0;
+            for (unsigned int k = 0, w = first; k < words; ++k, w = (w + 1) % fWords) {
+                any |= left[w] & right[w];
+            } // end for
+
+            if (any == 0)
+                continue;
+
+            insert(head, end);
+            insert(this->column(rule.head), (start - 1) % fRing);
+        } // end for
+    } // end for
+
+    std::vector<Window> windows;
+
+    if (!fGrammar.hasStart())
+        return windows;
+
+    for (unsigned long l = 1; l <= fSpan && l <= j; ++l) {
+        if (test(this->row(fGrammar.start(), j - l + 1), end))
+            windows.push_back(Window(j - l + 1, j));
+    } // end for
+
+    return windows;
+}
+
+void CYKScanner::scan(std::istream& in, const std::function<void(const Window&)>& report) {
+    char c;
+
+    while (in.get(c)) {
+        if (std::isspace(static_cast<unsigned char>(c)))
+            continue;
+
+        for (const Window& w : this->push(c)) {
+            report(w);
+        } // end for
+    } // end while
+}
+
+unsigned long CYKScanner::position() const {
+    return fPosition;
+}
+
+CYKWord* CYKScanner::row(const unsigned int& id, const unsigned long& start) {
+    return fRows.data() + (std::size_t(id) * fSpan + start % fSpan) * fWords;
+}
+
+CYKWord* CYKScanner::column(const unsigned int& id) {
+    return fColumns.data() + std::size_t(id) * fWords;
+}
+
+CYKSession::CYKSession(const CYKGrammar& grammar)
+    : fGrammar(grammar), fLength(0), fWords(0) {
+}
+
+void CYKSession::append(const char& terminal) {
+    if (!fGrammar.isTerminal(terminal))
+        throw std::invalid_argument("Invalid terminal string.");
+
+    const unsigned int j = ++fLength;
+    const unsigned int size = fGrammar.size();
+
+    // make room for bit j in all rows and columns
+    if (j / BITS + 1 > fWords) {
+        ++fWords;
+
+        for (std::vector<CYKWord>& r : fRows) {
+            r.push_back(0);
+        } // end for
+    } // end if
+
+    fRows.resize(fRows.size() + size, std::vector<CYKWord>(fWords, 0));
+    fColumns.assign(std::size_t(size) * fWords, 0);
+
+    // base case: the substring of length 1
+    const CYKWord* t = fGrammar.terminal(terminal);
+    for (unsigned int a = 0; a < size; ++a) {
+        if (!test(t, a))
+            continue;
+
+        insert(this->row(a, j).data(), j);
+        insert(fColumns.data() + std::size_t(a) * fWords, j - 1);
+    } // end for
+
+    // inductive part: the longer substrings ending at j, shortest first
+    for (unsigned int i = j - 1; i >= 1; --i) {
+        // the words holding the split points i <= e < j
+        const unsigned int first = i / BITS;
+        const unsigned int last = (j - 1) / BITS;
+
+        for (const CYKGrammar::BinaryRule& rule : fGrammar.binaryRules()) {
+            std::vector<CYKWord>& head = this->row(rule.head, i);
+
+            if (test(head.data(), j))
+                continue;
+
+            const CYKWord* left = this->row(rule.left, i).data();
+            const CYKWord* right = fColumns.data() + std::size_t(rule.right) * fWords;
+
+            CYKWord any = 0;
+            for (unsigned int w = first; w <= last; ++w) {
+                any |= left[w] & right[w];
+            } // end for
+
+            if (any == 0)
+                continue;
+
+            insert(head.data(), j);
+            insert(fColumns.data() + std::size_t(rule.head) * fWords, i - 1);
+        } // end for
+    } // end for
+}
+
+void CYKSession::append(const std::string& terminalstring) {
+    for (const char& t : terminalstring) {
+        this->append(t);
+    } // end for
+}
+
+unsigned int CYKSession::length() const {
+    return fLength;
+}
+
+bool CYKSession::accepted() const {
+    if (fLength == 0)
+        return false;
+
+    return this->accepted(1);
+}
+
+bool CYKSession::accepted(const unsigned int& i) const {
+    if (!fGrammar.hasStart())
+        return false;
+
+    return this->derives(fGrammar.start(), i, fLength - i + 1);
+}
+
+bool CYKSession::derives(const unsigned int& id, const unsigned int& i, const unsigned int& l) const {
+    return test(fRows.at(std::size_t(i - 1) * fGrammar.size() + id).data(), i + l - 1);
+}
+
+std::vector<CYKWord>& CYKSession::row(const unsigned int& id, const unsigned int& i) {
+    return fRows[std::size_t(i - 1) * fGrammar.size() + id];
+}
+
+std::vector<bool> batchCYK(
+    const CYKGrammar& grammar,
+    const std::vector<std::string>& terminalstrings,
+    const unsigned int& threads
+    ) {
+    return batchCYK(grammar, terminalstrings, CYKPool::shared(threads));
+}
+
+std::vector<bool> batchCYK(
+    const CYKGrammar& grammar,
+    const std::vector<std::string>& terminalstrings,
+    CYKPool& pool
+    ) {
+    // check everything first, so the workers can't throw
+    for (const std::string& s : terminalstrings) {
+        grammar.validate(s);
+    } // end for
+
+    // not a std::vector<bool>, the workers write to it simultaneously
+    std::vector<char> accepted(terminalstrings.size(), false);
+    std::atomic<std::size_t> next(0);
+
+    pool.run([&](const unsigned int&) {
+        // one scratch table for all the strings of this worker
+        CYKMatrix matrix(grammar);
+
+        for (std::size_t i = next++; i < terminalstrings.size(); i = next++) {
+            matrix.parse(terminalstrings[i]);
+            accepted[i] = matrix.accepted();
+        } // end for
+    });
+
+    return std::vector<bool>(accepted.begin(), accepted.end());
+}
+
+CYKParse::CYKParse(
+    const CYKGrammar& grammar,
+    const std::string& terminalstring,
+    const bool& count
+    ) : fGrammar(grammar), fString(terminalstring), fCount(count) {
+    fGrammar.validate(terminalstring);
+
+    const unsigned int n = fString.size();
+    const unsigned int words = fGrammar.words();
+    const unsigned int size = fGrammar.size();
+    const auto& rules = fGrammar.binaryRules();
+    const unsigned long long max = std::numeric_limits<unsigned long long>::max();
+    const std::size_t cells = std::size_t(n) * (n + 1) / 2;
+
+    fCells.assign(cells * words, 0);
+    fFirst.assign(1, 0);
+    fFirst.reserve(cells + 1);
+
+    // the back-pointers and counts of the cell being filled, indexed by id
+    std::vector<CYKWord> back(size, 0);
+    std::vector<CYKWord> counts(size, 0);
+
+    // the rules A --> BC with B and C deriving the two parts of a split
+    std::vector<unsigned int> matches;
+
+    // keep the entries of the variables in the cell, in order of their id
+    auto store = [&](const CYKWord* cell) {
+        for (unsigned int w = 0; w < words; ++w) {
+            CYKWord bits = cell[w];
+
+            while (bits != 0) {
+                const unsigned int a = w * BITS + __builtin_ctzll(bits);
+                bits &= bits - 1;
+
+                fBack.push_back(back[a]);
+
+                if (fCount)
+                    fCounts.push_back(counts[a]);
+            } // end while
+        } // end for
+
+        fFirst.push_back(fBack.size());
+    };
+
+    // base case: the substrings of length 1, back-pointer 0 means A --> a
+    for (unsigned int i = 1; i <= n; ++i) {
+        CYKWord* cell = fCells.data() + this->cell(i, 1) * words;
+        const CYKWord* t = fGrammar.terminal(fString.at(i-1));
+
+        std::copy(t, t + words, cell);
+        std::fill(back.begin(), back.end(), 0);
+        std::fill(counts.begin(), counts.end(), 1);
+        store(cell);
+    } // end for
+
+    // inductive part, back-pointer (rule + 1) << 32 | m for A --> BC with B
+    // deriving the first m terminals
+    for (unsigned int l = 2; l <= n; ++l) {
+        for (unsigned int i = 1; i + l - 1 <= n; ++i) {
+            CYKWord* cell = fCells.data() + this->cell(i, l) * words;
+
+            if (fCount)
+                std::fill(counts.begin(), counts.end(), 0);
+
+            for (unsigned int m = 1; m < l; ++m) {
+                const std::size_t x = this->cell(i, m);
+                const std::size_t y = this->cell(i + m, l - m);
+                const CYKWord* left = fCells.data() + x * words;
+                const CYKWord* right = fCells.data() + y * words;
+
+                matches.clear();
+                fGrammar.matches(left, right, matches);
+
+                for (const unsigned int& r : matches) {
+                    const CYKGrammar::BinaryRule& rule = rules[r];
+
+                    if (!test(cell, rule.head)) {
+                        insert(cell, rule.head);
+                        back[rule.head] = (CYKWord(r + 1) << 32) | m;
+                    } else if (!fCount) {
+                        continue;
+                    } // end if-else
+
+                    if (fCount) {
+                        const CYKWord b = fCounts[this->entry(rule.left, x)];
+                        const CYKWord c = fCounts[this->entry(rule.right, y)];
+                        CYKWord& a = counts[rule.head];
+
+                        // saturate instead of overflowing
+                        if (c != 0 && b > max / c) {
+                            a = max;
+                        } else {
+                            a = (max - a < b * c) ? max : a + b * c;
+                        } // end if-else
+                    } // end if
+                } // end for
+            } // end for
+
+            store(cell);
+        } // end for
+    } // end for
+}
+
+unsigned int CYKParse::length() const {
+    return fString.size();
+}
+
+bool CYKParse::derives(const unsigned int& id, const unsigned int& i, const unsigned int& l) const {
+    return test(fCells.data() + this->cell(i, l) * fGrammar.words(), id);
+}
+
+bool CYKParse::accepted() const {
+    if (fString.empty() || !fGrammar.hasStart())
+        return false;
+
+    return this->derives(fGrammar.start(), 1, fString.size());
+}
+
+CYKTree CYKParse::tree() const {
+    if (!this->accepted())
+        throw std::runtime_error("The string is not in the language.");
+
+    return this->tree(fGrammar.start(), 1, fString.size());
+}
+
+CYKTree CYKParse::tree(const unsigned int& id, const unsigned int& i, const unsigned int& l) const {
+    if (!this->derives(id, i, l))
+        throw std::runtime_error("The variable does not derive the substring.");
+
+    return rebuild(fGrammar, fString, id, i, l,
+                   [&](const unsigned int& a, const unsigned int& start, const unsigned int& length) {
+        return fBack[this->entry(a, this->cell(start, length))];
+    });
+}
+
+unsigned long long CYKParse::derivations() const {
+    if (fString.empty() || !fGrammar.hasStart())
+        return 0;
+
+    return this->derivations(fGrammar.start(), 1, fString.size());
+}
+
+unsigned long long CYKParse::derivations(const unsigned int& id, const unsigned int& i, const unsigned int& l) const {
+    if (!fCount)
+        throw std::runtime_error("The derivations were not counted.");
+
+    if (!this->derives(id, i, l))
+        return 0;
+
+    return fCounts[this->entry(id, this->cell(i, l))];
+}
+
+std::size_t CYKParse::cell(const unsigned int& i, const unsigned int& l) const {
+    const std::size_t n = fString.size();
+    const std::size_t before = std::size_t(l - 1) * (n + 1) - std::size_t(l - 1) * l / 2;
+
+    return before + i - 1;
+}
+
+std::size_t CYKParse::entry(const unsigned int& id, const std::size_t& cell) const {
+    const CYKWord* bits = fCells.data() + cell * fGrammar.words();
+    const unsigned int w = id / BITS;
+    std::size_t rank = __builtin_popcountll(bits[w] & ((CYKWord(1) << (id % BITS)) - 1));
+
+    for (unsigned int v = 0; v < w; ++v) {
+        rank += __builtin_popcountll(bits[v]);
+    } // end for
+
+    return fFirst[cell] + rank;
+}
+
+CYKScore::CYKScore(const CYKGrammar& grammar, const std::string& terminalstring)
+    : fGrammar(grammar), fString(terminalstring) {
+    fGrammar.validate(terminalstring);
+
+    const unsigned int n = fString.size();
+    const unsigned int words = fGrammar.words();
+    const unsigned int size = fGrammar.size();
+    const auto& rules = fGrammar.binaryRules();
+    const std::size_t cells = std::size_t(n) * (n + 1) / 2;
+
+    fCells.assign(cells * words, 0);
+    fViterbi.assign(cells * size, -std::numeric_limits<double>::infinity());
+    fInside.assign(cells * size, -std::numeric_limits<double>::infinity());
+    fBack.assign(cells * size, 0);
+
+    // the rules A --> BC for each B
+    std::vector< std::vector<unsigned int> > byLeft(size);
+    for (unsigned int r = 0; r < rules.size(); ++r) {
+        byLeft.at(rules[r].left).push_back(r);
+    } // end for
+
+    // base case: the substrings of length 1
+    for (unsigned int i = 1; i <= n; ++i) {
+        const std::size_t c = this->cell(i, 1);
+        const CYKWord* t = fGrammar.terminal(fString.at(i-1));
+
+        std::copy(t, t + words, fCells.begin() + c * words);
+
+        for (unsigned int a = 0; a < size; ++a) {
+            if (test(t, a))
+                fViterbi[c * size + a] = fInside[c * size + a] = fGrammar.weight(a, fString.at(i-1));
+        } // end for
+    } // end for
+
+    // inductive part
+    for (unsigned int l = 2; l <= n; ++l) {
+        for (unsigned int i = 1; i + l - 1 <= n; ++i) {
+            const std::size_t c = this->cell(i, l);
+            CYKWord* set = fCells.data() + c * words;
+            double* viterbi = fViterbi.data() + c * size;
+            double* inside = fInside.data() + c * size;
+            CYKWord* back = fBack.data() + c * size;
+
+            for (unsigned int m = 1; m < l; ++m) {
+                const std::size_t left = this->cell(i, m);
+                const std::size_t right = this->cell(i + m, l - m);
+                const CYKWord* rightSet = fCells.data() + right * words;
+
+                // only the variables B deriving the first part
+                for (unsigned int w = 0; w < words; ++w) {
+                    CYKWord bits = fCells[left * words + w];
+
+                    while (bits != 0) {
+                        const unsigned int b = w * BITS + __builtin_ctzll(bits);
+                        bits &= bits - 1;
+
+                        for (const unsigned int& r : byLeft[b]) {
+                            const CYKGrammar::BinaryRule& rule = rules[r];
+
+                            if (!test(rightSet, rule.right))
+                                continue;
+
+                            const double best = rule.weight + fViterbi[left * size + b] + fViterbi[right * size + rule.right];
+                            const double all = rule.weight + fInside[left * size + b] + fInside[right * size + rule.right];
+
+                            if (!test(set, rule.head)) {
+                                insert(set, rule.head);
+                                viterbi[rule.head] = best;
+                                inside[rule.head] = all;
+                                back[rule.head] = (CYKWord(r + 1) << 32) | m;
+                            } else {
+                                if (best > viterbi[rule.head]) {
+                                    viterbi[rule.head] = best;
+                                    back[rule.head] = (CYKWord(r + 1) << 32) | m;
+                                } // end if
+
+                                inside[rule.head] = logAdd(inside[rule.head], all);
+                            } // end if-else
+                        } // end for
+                    } // end while
+                } // end for
+            } // end for
+        } // end for
+    } // end for
+}
+
+unsigned int CYKScore::length() const {
+    return fString.size();
+}
+
+bool CYKScore::accepted() const {
+    if (fString.empty() || !fGrammar.hasStart())
+        return false;
+
+    return test(fCells.data() + this->cell(1, fString.size()) * fGrammar.words(), fGrammar.start());
+}
+
+double CYKScore::viterbi() const {
+    if (!this->accepted())
+        return -std::numeric_limits<double>::infinity();
+
+    return this->viterbi(fGrammar.start(), 1, fString.size());
+}
+
+double CYKScore::viterbi(const unsigned int& id, const unsigned int& i, const unsigned int& l) const {
+    return fViterbi[this->cell(i, l) * fGrammar.size() + id];
+}
+
+double CYKScore::inside() const {
+    if (!this->accepted())
+        return -std::numeric_limits<double>::infinity();
+
+    return this->inside(fGrammar.start(), 1, fString.size());
+}
+
+double CYKScore::inside(const unsigned int& id, const unsigned int& i, const unsigned int& l) const {
+    return fInside[this->cell(i, l) * fGrammar.size() + id];
+}
+
+CYKTree CYKScore::tree() const {
+    if (!this->accepted())
+        throw std::runtime_error("The string is not in the language.");
+
+    return this->tree(fGrammar.start(), 1, fString.size());
+}
+
+CYKTree CYKScore::tree(const unsigned int& id, const unsigned int& i, const unsigned int& l) const {
+    if (!test(fCells.data() + this->cell(i, l) * fGrammar.words(), id))
+        throw std::runtime_error("The variable does not derive the substring.");
+
+    const std::size_t size = fGrammar.size();
+
+    return rebuild(fGrammar, fString, id, i, l,
+                   [&](const unsigned int& a, const unsigned int& start, const unsigned int& length) {
+        return fBack[this->cell(start, length) * size + a];
+    });
+}
+
+std::size_t CYKScore::cell(const unsigned int& i, const unsigned int& l) const {
+    const std::size_t n = fString.size();
+
+    return std::size_t(l - 1) * (n + 1) - std::size_t(l - 1) * l / 2 + i - 1;
+}
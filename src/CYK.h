@@ -0,0 +1,890 @@
+/* CYK
+ * Interface declaration of the table based CYK engines for a CNF.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_CYK_H
+#define H_CYK_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <utility>
+
+class CNF;
+class IndexedGrammar;
+
+/**
+ * @brief One word of a variable bitset. A set of variables is stored as
+ * a row of CYKGrammar::words() of these.
+ */
+typedef std::uint64_t CYKWord;
+
+/**
+ * @brief The compiled form of a CNF, as used by the table based CYK
+ * engines. Every variable gets a dense id (so a set of variables becomes a
+ * bitset) and the production rules are turned into lookup tables:
+ * - for each terminal a the set of variables A with A --> a,
+ * - for each pair of variables (B, C) the list of variables A with A --> BC.
+ */
+class CYKGrammar {
+public:
+    /**
+     * @brief A production rule of the form head --> left right, in terms
+     * of variable ids.
+     */
+    struct BinaryRule {
+        unsigned int head;
+        unsigned int left;
+        unsigned int right;
+
+        // the log weight, see CNF::weight()
+        double weight;
+    };
+
+    /**
+     * @brief Constructor, compiles the production rules of the CNF.
+     *
+     * @param cnf The CNF to be compiled.
+     */
+    explicit CYKGrammar(const CNF& cnf);
+
+    /**
+     * @brief Constructor, compiles the production rules of a grammar with
+     * integer symbols. Variables without a name get name 0, id() only finds
+     * the first variable with a name.
+     *
+     * @param grammar The grammar to be compiled.
+     *
+     * @throw std::invalid_argument if the grammar is not in Chomsky Normal
+     * Form (see IndexedGrammar::toCNF()).
+     */
+    explicit CYKGrammar(const IndexedGrammar& grammar);
+
+    /**
+     * @brief Get the amount of variables (and so the amount of ids).
+     */
+    unsigned int size() const;
+
+    /**
+     * @brief Get the amount of words in a variable bitset.
+     */
+    unsigned int words() const;
+
+    /**
+     * @brief Check whether the start symbol has production rules at all.
+     * If not, no string is in the language.
+     */
+    bool hasStart() const;
+
+    /**
+     * @brief Get the id of the start symbol.
+     *
+     * @pre hasStart()
+     */
+    unsigned int start() const;
+
+    /**
+     * @brief Get the id of the passed variable.
+     *
+     * @return The id, or -1 if the variable has no production rules.
+     */
+    int id(const char& v) const;
+
+    /**
+     * @brief Get the variable with the passed id.
+     */
+    char variable(const unsigned int& id) const;
+
+    /**
+     * @brief Check whether the passed symbol is a terminal of the CNF.
+     */
+    bool isTerminal(const char& t) const;
+
+    /**
+     * @brief Get the set of variables A with a production A --> t.
+     *
+     * @pre isTerminal(t)
+     */
+    const CYKWord* terminal(const char& t) const;
+
+    /**
+     * @brief Get the log weight of the production rule A --> t, with A the
+     * variable with the passed id.
+     *
+     * @return The log weight, or -infinity if there's no such rule.
+     *
+     * @pre isTerminal(t)
+     */
+    double weight(const unsigned int& id, const char& t) const;
+
+    /**
+     * @brief Get all the production rules of the form A --> BC.
+     */
+    const std::vector<BinaryRule>& binaryRules() const;
+
+    /**
+     * @brief Get the variables A with a production A --> BC.
+     *
+     * @return The range of ids, sorted, both nullptr if there's no such
+     * rule.
+     */
+    std::pair<const unsigned int*, const unsigned int*> heads(
+        const unsigned int& left,
+        const unsigned int& right
+        ) const;
+
+    /**
+     * @brief Add all variables A with a production A --> BC with B in left
+     * and C in right to the set out.
+     *
+     * @param left The variables deriving the first part of a substring.
+     * @param right The variables deriving the second part of a substring.
+     * @param out The variables deriving the whole substring.
+     */
+    void combine(const CYKWord* left, const CYKWord* right, CYKWord* out) const;
+
+    /**
+     * @brief Append the indices in binaryRules() of all production rules
+     * A --> BC with B in left and C in right to rules, grouped on B, then
+     * on C.
+     *
+     * @param left The variables deriving the first part of a substring.
+     * @param right The variables deriving the second part of a substring.
+     * @param rules The indices found.
+     */
+    void matches(const CYKWord* left, const CYKWord* right, std::vector<unsigned int>& rules) const;
+
+    /**
+     * @brief Check whether the passed string consists of terminals only.
+     *
+     * @throw std::invalid_argument if not.
+     */
+    void validate(const std::string& terminalstring) const;
+
+private:
+    // the variables, indexed by their id
+    std::vector<char> fVariables;
+
+    // the ids of the variables, indexed by the (unsigned) variable, -1 if none
+    std::vector<int> fIds;
+
+    // for each terminal (unsigned char) its index, -1 if it is not a
+    // terminal. Its bitset starts at index * fWords in fMasks.
+    std::vector<int> fTerminals;
+
+    // the log weights of the rules A --> a, for each terminal a row with a
+    // weight for each variable
+    std::vector<double> fTerminalWeights;
+
+    std::vector<BinaryRule> fBinaryRules;
+
+    // the pairs (B, C) with a rule A --> BC, sorted: the pairs of B are
+    // fPairs[B] up to fPairs[B + 1], with C in fRights and the heads A in
+    // fHeads from fFirstHeads up to the next one. fIndices holds the
+    // indices in fBinaryRules of those pairs in the same way.
+    std::vector<std::size_t> fPairs;
+    std::vector<unsigned int> fRights;
+    std::vector<std::size_t> fFirstHeads;
+    std::vector<unsigned int> fHeads;
+    std::vector<std::size_t> fFirstIndices;
+    std::vector<unsigned int> fIndices;
+
+    // the bitsets of the terminals, one after the other
+    std::vector<CYKWord> fMasks;
+
+    unsigned int fWords;
+
+    int fStart;
+};
+
+/**
+ * @brief A fixed amount of threads, started once and reused for each
+ * parallel run of CYKTable and batchCYK, so many short parses don't pay for
+ * creating and joining threads each time.
+ *
+ * @note One run at a time: run() blocks until an earlier run (from another
+ * thread) is done.
+ */
+class CYKPool {
+public:
+    /**
+     * @brief Constructor, starts the threads.
+     *
+     * @param threads The amount of threads of a run, including the calling
+     * thread, 0 means one for each hardware thread.
+     */
+    explicit CYKPool(const unsigned int& threads = 0);
+
+    /**
+     * @brief Destructor, stops the threads.
+     */
+    ~CYKPool();
+
+    CYKPool(const CYKPool&) = delete;
+    CYKPool& operator=(const CYKPool&) = delete;
+
+    /**
+     * @brief Get the amount of threads of a run.
+     */
+    unsigned int size() const;
+
+    /**
+     * @brief Call task(t) once for each thread t (0 <= t < size()), the
+     * calling thread being thread 0, and wait until all of them are done.
+     *
+     * @pre The task doesn't throw.
+     */
+    void run(const std::function<void(const unsigned int&)>& task);
+
+    /**
+     * @brief Get the pool with the passed amount of threads shared by the
+     * whole program, started on first use.
+     *
+     * @param threads The amount of threads, 0 means one for each hardware
+     * thread.
+     */
+    static CYKPool& shared(const unsigned int& threads = 0);
+
+private:
+    // the loop of thread t
+    void work(const unsigned int& t);
+
+    std::vector<std::thread> fThreads;
+
+    // held during a whole run
+    std::mutex fRun;
+
+    std::mutex fMutex;
+    std::condition_variable fStart;
+    std::condition_variable fDone;
+
+    // the task of the current run, counted by fGeneration
+    const std::function<void(const unsigned int&)>* fTask;
+    unsigned long fGeneration;
+
+    // the threads still busy with the current run
+    unsigned int fBusy;
+
+    bool fStop;
+};
+
+/**
+ * @brief The CYK table for one string as a flat array of variable bitsets,
+ * one for each cell. The cells are stored diagonal by diagonal, that is, all
+ * the substrings of length 1 first, then those of length 2 and so on.
+ *
+ * @note Positions are 1-based, just as in CNF::CYK: cell(i, l) is the set of
+ * variables deriving the substring starting at position i of length l.
+ */
+class CYKTable {
+public:
+    /**
+     * @brief Constructor, fills the table.
+     *
+     * @param grammar The compiled CNF.
+     * @param terminalstring The string to be parsed.
+     * @param threads The amount of threads filling the table, more than one
+     * uses the shared CYKPool of that size (see the constructor below).
+     *
+     * @throw std::invalid_argument if the string passed is not a valid
+     * terminal string.
+     */
+    CYKTable(
+        const CYKGrammar& grammar,
+        const std::string& terminalstring,
+        const unsigned int& threads = 1
+        );
+
+    /**
+     * @brief Constructor, fills the table with the threads of a pool. The
+     * cells on one diagonal don't depend on each other, so each thread
+     * fills its own part of the diagonal before all of them move on to the
+     * next one. The last diagonals have fewer cells than there are threads,
+     * those are filled by the calling thread alone.
+     *
+     * @param grammar The compiled CNF.
+     * @param terminalstring The string to be parsed.
+     * @param pool The threads filling the table.
+     *
+     * @throw std::invalid_argument if the string passed is not a valid
+     * terminal string.
+     */
+    CYKTable(const CYKGrammar& grammar, const std::string& terminalstring, CYKPool& pool);
+
+    /**
+     * @brief Get the length of the parsed string.
+     */
+    unsigned int length() const;
+
+    /**
+     * @brief Get the set of variables deriving the substring starting at
+     * position i with length l.
+     *
+     * @pre 1 <= i, 1 <= l and i + l - 1 <= length()
+     */
+    const CYKWord* cell(const unsigned int& i, const unsigned int& l) const;
+
+    /**
+     * @brief Check whether the variable with the passed id derives the
+     * substring starting at position i with length l.
+     */
+    bool derives(const unsigned int& id, const unsigned int& i, const unsigned int& l) const;
+
+    /**
+     * @brief Check whether the whole string is in the language of the CNF.
+     */
+    bool accepted() const;
+
+private:
+    // the index of the first word of cell (i, l)
+    std::size_t offset(const unsigned int& i, const unsigned int& l) const;
+
+    // fill the base case of the table
+    void initialize(const std::string& terminalstring);
+
+    // fill the inductive part of the table with the threads of the pool
+    void wavefront(CYKPool& pool);
+
+    // fill the cells (i, l) for first <= i < last
+    void fill(const unsigned int& l, const unsigned int& first, const unsigned int& last);
+
+    const CYKGrammar& fGrammar;
+
+    unsigned int fLength;
+
+    std::vector<CYKWord> fCells;
+};
+
+/**
+ * @brief The CYK algorithm as boolean matrix products, one row at a time.
+ * Each variable A gets a bit matrix M(A) with M(A)[i][j] set iff A derives
+ * the substring from position i up to (but not including) j (0-based). For
+ * the production rules A --> BC row i of M(A) is the OR of the rows k of
+ * M(C) with M(B)[i][k] set, that is, row i of the product M(B)M(C). The
+ * rows are filled from the last one to the first, and within a row the
+ * split points k from left to right, so every bit used is already final.
+ *
+ * @note This gives the same result as CYKTable, but one OR of two rows
+ * handles a split point for all the ends j at once, 64 positions a word,
+ * instead of a single cell. Only the variables B deriving the substring
+ * from i up to k are looked at, through the (B, C) index of CYKGrammar.
+ */
+class CYKMatrix {
+public:
+    /**
+     * @brief Constructor, for the empty string. Use parse() to fill the
+     * matrices for a string.
+     *
+     * @param grammar The compiled CNF.
+     */
+    explicit CYKMatrix(const CYKGrammar& grammar);
+
+    /**
+     * @brief Constructor, fills the matrices.
+     *
+     * @param grammar The compiled CNF.
+     * @param terminalstring The string to be parsed.
+     *
+     * @throw std::invalid_argument if the string passed is not a valid
+     * terminal string.
+     */
+    CYKMatrix(const CYKGrammar& grammar, const std::string& terminalstring);
+
+    /**
+     * @brief Fill the matrices for another string, reusing the memory of
+     * the previous one.
+     *
+     * @param terminalstring The string to be parsed.
+     *
+     * @throw std::invalid_argument if the string passed is not a valid
+     * terminal string.
+     */
+    void parse(const std::string& terminalstring);
+
+    /**
+     * @brief Get the length of the parsed string.
+     */
+    unsigned int length() const;
+
+    /**
+     * @brief Check whether the variable with the passed id derives the
+     * substring starting at position i with length l (1-based, as in
+     * CYKTable).
+     */
+    bool derives(const unsigned int& id, const unsigned int& i, const unsigned int& l) const;
+
+    /**
+     * @brief Check whether the whole string is in the language of the CNF.
+     */
+    bool accepted() const;
+
+private:
+    // row i of M(id)
+    CYKWord* row(const unsigned int& id, const unsigned int& i);
+
+    const CYKGrammar& fGrammar;
+
+    unsigned int fLength;
+
+    // the amount of words in a row of a matrix
+    unsigned int fWords;
+
+    // the rows of all matrices: row i of M(A) is at (A * (n+1) + i) * fWords
+    std::vector<CYKWord> fRows;
+
+    // scratch space of parse(): the set of all variables, the variables B
+    // with M(B)[i][k] set and the rules A --> BC found for those
+    std::vector<CYKWord> fAll;
+    std::vector<CYKWord> fLeft;
+    std::vector<unsigned int> fMatches;
+};
+
+/**
+ * @brief Banded CYK for long (streamed) strings: only substrings of at most
+ * a given length (the span) are considered. The terminals are pushed one by
+ * one, and each push reports the accepted substrings ending at the new
+ * position.
+ *
+ * For each variable it keeps the rows of CYKMatrix for the last span start
+ * positions and the column of the current end position, with the positions
+ * stored modulo a ring of a bit more than span bits. The memory use only depends on the span and the
+ * grammar, not on the length of the string.
+ */
+class CYKScanner {
+public:
+    /**
+     * @brief A substring as the first and the last position (1-based).
+     */
+    typedef std::pair<unsigned int, unsigned int> Window;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param grammar The compiled CNF.
+     * @param span The maximum length of the substrings.
+     *
+     * @throw std::invalid_argument if the span is 0.
+     */
+    CYKScanner(const CYKGrammar& grammar, const unsigned int& span);
+
+    /**
+     * @brief Append a terminal to the string.
+     *
+     * @param terminal The next terminal of the string.
+     *
+     * @return The substrings of at most span terminals that end at the new
+     * position and are in the language of the CNF, shortest first.
+     *
+     * @throw std::invalid_argument if the passed symbol is not a terminal.
+     */
+    std::vector<Window> push(const char& terminal);
+
+    /**
+     * @brief Push all the terminals of a stream (skipping white space) and
+     * report the accepted substrings as they are found.
+     *
+     * @param in The stream to read the terminals from.
+     * @param report Called with each accepted substring.
+     *
+     * @throw std::invalid_argument if the stream contains an invalid symbol.
+     */
+    void scan(std::istream& in, const std::function<void(const Window&)>& report);
+
+    /**
+     * @brief Get the amount of terminals pushed so far.
+     */
+    unsigned long position() const;
+
+private:
+    // the row of variable id for the substrings starting at the passed
+    // position
+    CYKWord* row(const unsigned int& id, const unsigned long& start);
+
+    // the column of variable id for the substrings ending at the current
+    // position
+    CYKWord* column(const unsigned int& id);
+
+    const CYKGrammar& fGrammar;
+
+    unsigned int fSpan;
+
+    // the size of the ring of positions, a multiple of the word size
+    unsigned int fRing;
+
+    // the amount of words in a row or column
+    unsigned int fWords;
+
+    unsigned long fPosition;
+
+    // for each variable span rows of fWords words
+    std::vector<CYKWord> fRows;
+
+    // for each variable one column of fWords words
+    std::vector<CYKWord> fColumns;
+};
+
+/**
+ * @brief Incremental CYK: a string that grows one terminal at a time. Each
+ * append only computes the substrings ending at the new position (the new
+ * column of the CYK table), in O(n^2) instead of O(n^3) for a whole new
+ * table.
+ *
+ * It uses the rows of CYKMatrix, for each start position and each variable
+ * the row of end positions, and for each variable the column of the
+ * current end position. The rows grow along with the string.
+ */
+class CYKSession {
+public:
+    /**
+     * @brief Constructor, starts with the empty string.
+     *
+     * @param grammar The compiled CNF.
+     */
+    explicit CYKSession(const CYKGrammar& grammar);
+
+    /**
+     * @brief Append a terminal to the string.
+     *
+     * @throw std::invalid_argument if the passed symbol is not a terminal.
+     */
+    void append(const char& terminal);
+
+    /**
+     * @brief Append all the terminals of the passed string.
+     *
+     * @throw std::invalid_argument if the string passed is not a valid
+     * terminal string (the terminals before the invalid one are appended).
+     */
+    void append(const std::string& terminalstring);
+
+    /**
+     * @brief Get the length of the string so far.
+     */
+    unsigned int length() const;
+
+    /**
+     * @brief Check whether the string so far is in the language of the CNF.
+     */
+    bool accepted() const;
+
+    /**
+     * @brief Check whether the suffix starting at position i (1-based) of
+     * the string so far is in the language of the CNF.
+     *
+     * @pre 1 <= i <= length()
+     */
+    bool accepted(const unsigned int& i) const;
+
+    /**
+     * @brief Check whether the variable with the passed id derives the
+     * substring starting at position i with length l (1-based, as in
+     * CYKTable).
+     *
+     * @pre 1 <= i, 1 <= l and i + l - 1 <= length()
+     */
+    bool derives(const unsigned int& id, const unsigned int& i, const unsigned int& l) const;
+
+private:
+    // the row of variable id for the substrings starting at position i:
+    // bit e is set iff the variable derives the substring from i to e
+    std::vector<CYKWord>& row(const unsigned int& id, const unsigned int& i);
+
+    const CYKGrammar& fGrammar;
+
+    unsigned int fLength;
+
+    // the amount of words in a row or column
+    unsigned int fWords;
+
+    // the rows, start position by start position
+    std::vector< std::vector<CYKWord> > fRows;
+
+    // for each variable the column of the last position: bit e is set iff
+    // the variable derives the substring from e + 1 to the last position
+    std::vector<CYKWord> fColumns;
+};
+
+/**
+ * @brief A node of a derivation tree: the variable and the substring it
+ * derives. The nodes of a tree are stored in a CYKTree, children as indices
+ * in that vector.
+ */
+struct CYKNode {
+    // the variable of the CNF
+    char variable;
+
+    // the substring: first position (1-based) and length
+    unsigned int start;
+    unsigned int length;
+
+    // for A --> BC the nodes of B and C, -1 for A --> a
+    int left;
+    int right;
+
+    // for A --> a the terminal a, 0 otherwise
+    char terminal;
+};
+
+/**
+ * @brief A derivation tree, the root is the first node.
+ */
+typedef std::vector<CYKNode> CYKTree;
+
+/**
+ * @brief The CYK table of CYKTable, extended with a back-pointer for each
+ * variable in each cell (the production rule and the split point of the
+ * first derivation found), and optionally the amount of derivations. Those
+ * are only stored for the variables in the set of the cell, one after the
+ * other, so the table grows with the amount of derived variables instead of
+ * the size of the grammar.
+ *
+ * A derivation tree can then be read from the table without parsing the
+ * string again.
+ */
+class CYKParse {
+public:
+    /**
+     * @brief Constructor, fills the table.
+     *
+     * @param grammar The compiled CNF.
+     * @param terminalstring The string to be parsed.
+     * @param count Also count the derivations. This needs all the split
+     * points of all the cells, so it is slower.
+     *
+     * @throw std::invalid_argument if the string passed is not a valid
+     * terminal string.
+     */
+    CYKParse(
+        const CYKGrammar& grammar,
+        const std::string& terminalstring,
+        const bool& count = false
+        );
+
+    /**
+     * @brief Get the length of the parsed string.
+     */
+    unsigned int length() const;
+
+    /**
+     * @brief Check whether the variable with the passed id derives the
+     * substring starting at position i with length l.
+     */
+    bool derives(const unsigned int& id, const unsigned int& i, const unsigned int& l) const;
+
+    /**
+     * @brief Check whether the whole string is in the language of the CNF.
+     */
+    bool accepted() const;
+
+    /**
+     * @brief Get a derivation tree of the whole string from the start
+     * symbol.
+     *
+     * @throw std::runtime_error if the string is not accepted.
+     */
+    CYKTree tree() const;
+
+    /**
+     * @brief Get a derivation tree of the substring starting at position i
+     * with length l from the variable with the passed id.
+     *
+     * @throw std::runtime_error if the variable doesn't derive the
+     * substring.
+     */
+    CYKTree tree(const unsigned int& id, const unsigned int& i, const unsigned int& l) const;
+
+    /**
+     * @brief Get the amount of derivations of the whole string from the
+     * start symbol (saturating at the maximum of unsigned long long).
+     *
+     * @throw std::runtime_error if the derivations weren't counted.
+     */
+    unsigned long long derivations() const;
+
+    /**
+     * @brief Get the amount of derivations of the substring starting at
+     * position i with length l from the variable with the passed id.
+     *
+     * @throw std::runtime_error if the derivations weren't counted.
+     */
+    unsigned long long derivations(const unsigned int& id, const unsigned int& i, const unsigned int& l) const;
+
+private:
+    // the index of cell (i, l), same order as CYKTable
+    std::size_t cell(const unsigned int& i, const unsigned int& l) const;
+
+    // the index in fBack (and fCounts) of the variable with the passed id
+    // in the passed cell
+    //
+    // @pre the variable is in the set of the cell
+    std::size_t entry(const unsigned int& id, const std::size_t& cell) const;
+
+    const CYKGrammar& fGrammar;
+
+    std::string fString;
+
+    bool fCount;
+
+    // the bitsets of the cells, words() words each
+    std::vector<CYKWord> fCells;
+
+    // the entries of cell k run from fFirst[k] up to fFirst[k + 1]
+    std::vector<std::size_t> fFirst;
+    std::vector<CYKWord> fBack;
+    std::vector<CYKWord> fCounts;
+};
+
+/**
+ * @brief The inside and Viterbi algorithm for a weighted CNF: for each cell
+ * of the CYK table and each variable the (log) sum of the weights of all
+ * derivations of the substring, and the (log) weight of the best one. The
+ * weight of a derivation is the product of the weights of its rules.
+ *
+ * Just as CYKParse, the tables are flat arrays in the order of CYKTable,
+ * with a back-pointer for each variable to rebuild the best derivation. Only
+ * the variables in the bitset of a cell are looked at.
+ */
+class CYKScore {
+public:
+    /**
+     * @brief Constructor, fills the tables.
+     *
+     * @param grammar The compiled CNF, see CNF::weight() for the weights.
+     * @param terminalstring The string to be scored.
+     *
+     * @throw std::invalid_argument if the string passed is not a valid
+     * terminal string.
+     */
+    CYKScore(const CYKGrammar& grammar, const std::string& terminalstring);
+
+    /**
+     * @brief Get the length of the scored string.
+     */
+    unsigned int length() const;
+
+    /**
+     * @brief Check whether the whole string is in the language of the CNF.
+     */
+    bool accepted() const;
+
+    /**
+     * @brief Get the log weight of the best derivation of the whole string
+     * from the start symbol, -infinity if the string is not accepted.
+     */
+    double viterbi() const;
+
+    /**
+     * @brief Get the log weight of the best derivation of the substring
+     * starting at position i with length l from the variable with the passed
+     * id, -infinity if there's none.
+     */
+    double viterbi(const unsigned int& id, const unsigned int& i, const unsigned int& l) const;
+
+    /**
+     * @brief Get the log of the sum of the weights of all derivations of the
+     * whole string from the start symbol, -infinity if there's none.
+     */
+    double inside() const;
+
+    /**
+     * @brief Get the log of the sum of the weights of all derivations of the
+     * substring starting at position i with length l from the variable with
+     * the passed id, -infinity if there's none.
+     */
+    double inside(const unsigned int& id, const unsigned int& i, const unsigned int& l) const;
+
+    /**
+     * @brief Get the best derivation tree of the whole string.
+     *
+     * @throw std::runtime_error if the string is not accepted.
+     */
+    CYKTree tree() const;
+
+    /**
+     * @brief Get the best derivation tree of the substring starting at
+     * position i with length l from the variable with the passed id.
+     *
+     * @throw std::runtime_error if the variable doesn't derive the
+     * substring.
+     */
+    CYKTree tree(const unsigned int& id, const unsigned int& i, const unsigned int& l) const;
+
+private:
+    // the index of cell (i, l), same order as CYKTable
+    std::size_t cell(const unsigned int& i, const unsigned int& l) const;
+
+    const CYKGrammar& fGrammar;
+
+    std::string fString;
+
+    // for each cell the bitset of variables deriving the substring
+    std::vector<CYKWord> fCells;
+
+    // for each cell and variable the best and the total log weight, and the
+    // back-pointer to the best derivation
+    std::vector<double> fViterbi;
+    std::vector<double> fInside;
+    std::vector<CYKWord> fBack;
+};
+
+/**
+ * @brief Check for each string of a batch whether it is in the language of
+ * the compiled CNF. The strings are divided over a pool of threads, each
+ * with its own CYKMatrix that is reused for all of its strings.
+ *
+ * @param grammar The compiled CNF, shared by all threads.
+ * @param terminalstrings The strings to be checked.
+ * @param threads The amount of threads, 0 means one for each hardware
+ * thread. The threads of the shared CYKPool of that size are used.
+ *
+ * @return For each string whether it is in the language.
+ *
+ * @throw std::invalid_argument if one of the strings is not a valid
+ * terminal string.
+ */
+std::vector<bool> batchCYK(
+    const CYKGrammar& grammar,
+    const std::vector<std::string>& terminalstrings,
+    const unsigned int& threads = 0
+    );
+
+/**
+ * @brief Check for each string of a batch whether it is in the language of
+ * the compiled CNF, as above, with the threads of a pool.
+ *
+ * @param grammar The compiled CNF, shared by all threads.
+ * @param terminalstrings The strings to be checked.
+ * @param pool The threads checking the strings.
+ *
+ * @return For each string whether it is in the language.
+ *
+ * @throw std::invalid_argument if one of the strings is not a valid
+ * terminal string.
+ */
+std::vector<bool> batchCYK(
+    const CYKGrammar& grammar,
+    const std::vector<std::string>& terminalstrings,
+    CYKPool& pool
+    );
+
+#endif // H_CYK_H
@@ -0,0 +1,269 @@
+/* Earley
+ * Implementation of the Earley recognizer.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Earley.h"
+#include <stdexcept>
+#include <utility>
+
+const int EarleyGrammar::COMPLETE;
+
+EarleyGrammar::EarleyGrammar(const CFG& cfg)
+    : fPredictions(256), fVariables(256, false), fTerminals(256, false), fNullable(256, false) {
+    for (const char& t : cfg.getTerminals()) {
+        fTerminals[static_cast<unsigned char>(t)] = true;
+    } // end for
+
+    for (const char& v : cfg.getVariables()) {
+        fVariables[static_cast<unsigned char>(v)] = true;
+    } // end for
+
+    for (const char& v : cfg.nullable()) {
+        fNullable[static_cast<unsigned char>(v)] = true;
+    } // end for
+
+    // S' --> S
+    fNext.push_back(static_cast<unsigned char>(cfg.getStartsymbol()));
+    fNext.push_back(COMPLETE);
+    fHeads.push_back(256);
+    fHeads.push_back(256);
+    fDots.push_back(0);
+    fDots.push_back(1);
+
+    for (const auto& p : cfg.getProductions()) {
+        const int head = static_cast<unsigned char>(p.first);
+        fPredictions[head].push_back(fNext.size());
+
+        for (unsigned int k = 0; k < p.second.size(); ++k) {
+            fNext.push_back(static_cast<unsigned char>(p.second[k]));
+            fHeads.push_back(head);
+            fDots.push_back(k);
+        } // end for
+
+        fNext.push_back(COMPLETE);
+        fHeads.push_back(head);
+        fDots.push_back(p.second.size());
+    } // end for
+}
+
+unsigned int EarleyGrammar::size() const {
+    return fNext.size();
+}
+
+unsigned int EarleyGrammar::start() const {
+    return 0;
+}
+
+int EarleyGrammar::next(const unsigned int& dotted) const {
+    return fNext[dotted];
+}
+
+int EarleyGrammar::head(const unsigned int& dotted) const {
+    return fHeads[dotted];
+}
+
+unsigned int EarleyGrammar::dot(const unsigned int& dotted) const {
+    return fDots[dotted];
+}
+
+const std::vector<unsigned int>& EarleyGrammar::predictions(const char& v) const {
+    return fPredictions[static_cast<unsigned char>(v)];
+}
+
+bool EarleyGrammar::isVariable(const char& s) const {
+    return fVariables[static_cast<unsigned char>(s)];
+}
+
+bool EarleyGrammar::isTerminal(const char& s) const {
+    return fTerminals[static_cast<unsigned char>(s)];
+}
+
+bool EarleyGrammar::isNullable(const char& v) const {
+    return fNullable[static_cast<unsigned char>(v)];
+}
+
+EarleyRecognizer::EarleyRecognizer(const EarleyGrammar& grammar, const std::string& str)
+    : fGrammar(grammar), fLength(str.size()), fFirst(1, 0), fTopmost(str.size() + 1) {
+    for (const char& t : str) {
+        if (!fGrammar.isTerminal(t))
+            throw std::invalid_argument("Invalid terminal string.");
+    } // end for
+
+    Item start = {fGrammar.start(), 0};
+    this->add(start);
+
+    // the items for the next position, found by scanning
+    std::vector<Item> scanned;
+
+    for (unsigned int i = 0; i <= fLength; ++i) {
+        // the items of position i are added while going over them
+        for (std::size_t k = fFirst[i]; k < fItems.size(); ++k) {
+            const Item item = fItems[k];
+            const int next = fGrammar.next(item.dotted);
+
+            if (next == EarleyGrammar::COMPLETE) {
+                // completer
+                const int head = fGrammar.head(item.dotted);
+
+                if (item.origin == i) {
+                    // position i isn't finished yet, see the predictor for
+                    // the nullable variables that are predicted later on
+                    this->complete(i, head);
+                } else {
+                    const Item top = this->topmost(item.origin, head);
+
+                    if (top.dotted != fGrammar.size()) {
+                        this->add(top);
+                    } else {
+                        this->complete(item.origin, head);
+                    } // end if-else
+                } // end if-else
+            } else if (fGrammar.isVariable(static_cast<char>(next))) {
+                // predictor
+                for (const unsigned int& d : fGrammar.predictions(static_cast<char>(next))) {
+                    const Item predicted = {d, i};
+                    this->add(predicted);
+                } // end for
+
+                if (fGrammar.isNullable(static_cast<char>(next))) {
+                    const Item skipped = {item.dotted + 1, item.origin};
+                    this->add(skipped);
+                } // end if
+            } else if (i < fLength && static_cast<unsigned char>(str[i]) == next) {
+                // scanner
+                const Item moved = {item.dotted + 1, item.origin};
+                scanned.push_back(moved);
+            } // end if-else
+        } // end for
+
+        fFirst.push_back(fItems.size());
+        fSeen.clear();
+
+        for (const Item& item : scanned) {
+            this->add(item);
+        } // end for
+
+        scanned.clear();
+    } // end for
+}
+
+bool EarleyRecognizer::accepted() const {
+    for (std::size_t k = fFirst[fLength]; k < fFirst[fLength + 1]; ++k) {
+        if (fItems[k].dotted == fGrammar.start() + 1 && fItems[k].origin == 0)
+            return true;
+    } // end for
+
+    return false;
+}
+
+unsigned int EarleyRecognizer::length() const {
+    return fLength;
+}
+
+std::size_t EarleyRecognizer::items() const {
+    return fItems.size();
+}
+
+std::size_t EarleyRecognizer::first(const unsigned int& i) const {
+    return fFirst.at(i);
+}
+
+const EarleyRecognizer::Item& EarleyRecognizer::item(const std::size_t& k) const {
+    return fItems.at(k);
+}
+
+void EarleyRecognizer::add(const Item& item) {
+    const unsigned long long key = static_cast<unsigned long long>(item.dotted) * (fLength + 1) + item.origin;
+
+    if (fSeen.insert(key).second)
+        fItems.push_back(item);
+}
+
+void EarleyRecognizer::complete(const unsigned int& j, const int& head) {
+    // position j is still growing if it's the current one
+    for (std::size_t k = fFirst[j]; k < (j + 1 < fFirst.size() ? fFirst[j + 1] : fItems.size()); ++k) {
+        const Item item = fItems[k];
+
+        if (fGrammar.next(item.dotted) == head) {
+            const Item moved = {item.dotted + 1, item.origin};
+            this->add(moved);
+        } // end if
+    } // end for
+}
+
+EarleyRecognizer::Item EarleyRecognizer::topmost(const unsigned int& j, const int& head) {
+    const Item none = {fGrammar.size(), 0};
+
+    // follow the chain down, as long as the topmost items aren't known yet:
+    // the position, the head and the completed item of each step
+    std::vector< std::pair< std::pair<unsigned int, int>, Item > > chain;
+    Item result = none;
+
+    unsigned int position = j;
+    int variable = head;
+    unsigned int predicted = 0;
+
+    while (true) {
+        auto known = fTopmost[position].find(variable);
+        if (known != fTopmost[position].end()) {
+            result = known->second;
+            break;
+        } // end if
+
+        // the item with the variable after the dot must be the only one,
+        // with the variable at the end of the body
+        unsigned int count = 0;
+        Item found = none;
+
+        for (std::size_t k = fFirst[position]; k < fFirst[position + 1] && count < 2; ++k) {
+            if (fGrammar.next(fItems[k].dotted) == variable) {
+                found = fItems[k];
+                ++count;
+            } // end if
+        } // end for
+
+        if (count != 1 || fGrammar.next(found.dotted + 1) != EarleyGrammar::COMPLETE) {
+            fTopmost[position][variable] = none;
+            break;
+        } // end if
+
+        const Item completed = {found.dotted + 1, found.origin};
+        chain.push_back(std::make_pair(std::make_pair(position, variable), completed));
+
+        // a predicted item leads to another variable of the same position,
+        // a cycle there can't consist of unique items but stop anyway
+        if (found.origin == position) {
+            if (++predicted > 256)
+                break;
+        } else {
+            predicted = 0;
+        } // end if-else
+
+        position = found.origin;
+        variable = fGrammar.head(found.dotted);
+    } // end while
+
+    // the topmost item of a step is the one of the step below it, if any
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        if (result.dotted == none.dotted)
+            result = it->second;
+
+        fTopmost[it->first.first][it->first.second] = result;
+    } // end for
+
+    return result;
+}
@@ -0,0 +1,199 @@
+/* Earley
+ * Interface declaration of an Earley recognizer working directly on the
+ * production rules of a CFG.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_EARLEY_H
+#define H_EARLEY_H
+
+#include "CFG.h"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief The compiled form of a CFG, as used by the Earley recognizer. The
+ * production rules don't have to be in any normal form, epsilon and unit
+ * productions are fine.
+ *
+ * Each production rule with a body of k symbols has k + 1 dotted rules
+ * (the positions of the dot), numbered one after the other, so moving the
+ * dot over a symbol is adding one. The rule S' --> S for the start symbol S
+ * is added as rule 0.
+ */
+class EarleyGrammar {
+public:
+    /**
+     * @brief The symbol after the dot of a dotted rule with the dot at the
+     * end.
+     */
+    static const int COMPLETE = -1;
+
+    /**
+     * @brief Constructor, compiles the production rules of the CFG.
+     *
+     * @param cfg The CFG to be compiled.
+     */
+    explicit EarleyGrammar(const CFG& cfg);
+
+    /**
+     * @brief Get the amount of dotted rules.
+     */
+    unsigned int size() const;
+
+    /**
+     * @brief Get the dotted rule S' --> .S of the start symbol S.
+     */
+    unsigned int start() const;
+
+    /**
+     * @brief Get the symbol after the dot (as unsigned char) or COMPLETE.
+     */
+    int next(const unsigned int& dotted) const;
+
+    /**
+     * @brief Get the head of the rule of a dotted rule (as unsigned char),
+     * 256 for S'.
+     */
+    int head(const unsigned int& dotted) const;
+
+    /**
+     * @brief Get the position of the dot, the amount of symbols before it.
+     */
+    unsigned int dot(const unsigned int& dotted) const;
+
+    /**
+     * @brief Get the dotted rules with the dot at the front of the
+     * production rules of a variable.
+     */
+    const std::vector<unsigned int>& predictions(const char& v) const;
+
+    /**
+     * @brief Check whether the passed symbol is a variable.
+     */
+    bool isVariable(const char& s) const;
+
+    /**
+     * @brief Check whether the passed symbol is a terminal.
+     */
+    bool isTerminal(const char& s) const;
+
+    /**
+     * @brief Check whether the passed variable is nullable.
+     */
+    bool isNullable(const char& v) const;
+
+private:
+    std::vector<int> fNext;
+    std::vector<int> fHeads;
+    std::vector<unsigned int> fDots;
+
+    // indexed by unsigned char
+    std::vector< std::vector<unsigned int> > fPredictions;
+    std::vector<bool> fVariables;
+    std::vector<bool> fTerminals;
+    std::vector<bool> fNullable;
+};
+
+/**
+ * @brief Earley recognizer of a string. The items (dotted rule, origin) of
+ * all positions are kept in one array, the items of position i are the ones
+ * from first(i) up to first(i+1).
+ *
+ * Epsilon rules are handled as described by Aycock and Horspool: predicting
+ * a nullable variable also moves the dot over it. Right recursion is handled
+ * as described by Leo: if the completion of a variable only leads to a chain
+ * of completed items, only the topmost one is added. This way the recognizer
+ * takes linear time for LR-regular grammars, and at most cubic time.
+ */
+class EarleyRecognizer {
+public:
+    /**
+     * @brief An item of the recognizer, a dotted rule and the position
+     * where its production rule started.
+     */
+    struct Item {
+        unsigned int dotted;
+        unsigned int origin;
+    };
+
+    /**
+     * @brief Constructor, recognizes the string.
+     *
+     * @param grammar The compiled CFG.
+     * @param str The string to be recognized.
+     *
+     * @throw std::invalid_argument if the string contains symbols that are
+     * not terminals of the grammar.
+     */
+    EarleyRecognizer(const EarleyGrammar& grammar, const std::string& str);
+
+    /**
+     * @brief Check whether the string is in the language of the grammar.
+     */
+    bool accepted() const;
+
+    /**
+     * @brief Get the length of the string.
+     */
+    unsigned int length() const;
+
+    /**
+     * @brief Get the total amount of items.
+     */
+    std::size_t items() const;
+
+    /**
+     * @brief Get the index of the first item of position i (from 0 to
+     * length() + 1, the last one is items()).
+     */
+    std::size_t first(const unsigned int& i) const;
+
+    /**
+     * @brief Get an item.
+     */
+    const Item& item(const std::size_t& k) const;
+
+private:
+    // add an item to the current position, unless it's already there
+    void add(const Item& item);
+
+    // add the items of position j with the symbol after the dot being the
+    // head of a complete item, with the dot moved over it
+    void complete(const unsigned int& j, const int& head);
+
+    // the topmost item of the chain of completed items when completing head
+    // from position j (Leo), dotted is grammar.size() if there is none
+    Item topmost(const unsigned int& j, const int& head);
+
+    const EarleyGrammar& fGrammar;
+    unsigned int fLength;
+
+    std::vector<Item> fItems;
+    std::vector<std::size_t> fFirst;
+
+    // the items of the current position, as dotted * (length + 1) + origin
+    std::unordered_set<unsigned long long> fSeen;
+
+    // the topmost items of position j for each head (memoized)
+    std::vector< std::map<int, Item> > fTopmost;
+};
+
+#endif // H_EARLEY_H
@@ -0,0 +1,306 @@
+/* GLL
+ * Implementation of the generalized LL parser.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GLL.h"
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+const int GLLParse::EPSILON;
+const int GLLParse::INTERMEDIATE;
+
+namespace {
+
+// the forest node of a descriptor that didn't read anything yet
+const int DUMMY = -1;
+
+// the name of a symbol in the dot format
+std::string symbolName(const int& symbol) {
+    if (symbol == 256)
+        return "S'";
+
+    const char c = static_cast<char>(symbol);
+
+    if (c == '"' || c == '\\')
+        return std::string("\\") + c;
+
+    return std::string(1, c);
+}
+
+} // end namespace
+
+GLLParse::GLLParse(const EarleyGrammar& grammar, const std::string& str)
+    : fGrammar(grammar), fString(str), fPacked(0), fRoot(-1) {
+    for (const char& t : str) {
+        if (!fGrammar.isTerminal(t))
+            throw std::invalid_argument("Invalid terminal string.");
+    } // end for
+
+    // the bottom of the stack, there's nothing to return to
+    StackNode bottom;
+    bottom.slot = fGrammar.size();
+    bottom.position = 0;
+    fStack.push_back(bottom);
+
+    this->add(fGrammar.start(), 0, 0, DUMMY);
+
+    while (!fDescriptors.empty()) {
+        const Descriptor d = fDescriptors.back();
+        fDescriptors.pop_back();
+
+        unsigned int slot = d.slot;
+        unsigned int position = d.position;
+        int node = d.node;
+
+        // read terminals until the slot is complete or at a variable
+        while (true) {
+            const int next = fGrammar.next(slot);
+
+            if (next == EarleyGrammar::COMPLETE) {
+                // an epsilon rule
+                if (fGrammar.dot(slot) == 0)
+                    node = this->packedNode(slot, DUMMY, this->forestNode(EPSILON, position, position));
+
+                this->pop(d.stack, position, node);
+                break;
+            } // end if
+
+            if (fGrammar.isVariable(static_cast<char>(next))) {
+                // call the variable, returning to the next slot
+                const unsigned int called = this->create(slot + 1, d.stack, position, node);
+
+                for (const unsigned int& p : fGrammar.predictions(static_cast<char>(next))) {
+                    this->add(p, called, position, DUMMY);
+                } // end for
+
+                break;
+            } // end if
+
+            if (position >= fString.size() || static_cast<unsigned char>(fString[position]) != next)
+                break;
+
+            const int terminal = this->forestNode(next, position, position + 1);
+            ++slot;
+            ++position;
+            node = this->packedNode(slot, node, terminal);
+        } // end while
+    } // end while
+
+    // the start symbol deriving the whole string
+    const unsigned long long length = fString.size() + 1;
+    const unsigned long long key = (static_cast<unsigned long long>(fGrammar.next(fGrammar.start())) * length) * length + fString.size();
+    auto it = fNodeIndex.find(key);
+
+    if (it != fNodeIndex.end())
+        fRoot = it->second;
+}
+
+bool GLLParse::accepted() const {
+    return fRoot != -1;
+}
+
+int GLLParse::root() const {
+    return fRoot;
+}
+
+std::size_t GLLParse::nodes() const {
+    return fNodes.size();
+}
+
+std::size_t GLLParse::packedNodes() const {
+    return fPacked;
+}
+
+const GLLParse::Node& GLLParse::node(const std::size_t& k) const {
+    return fNodes.at(k);
+}
+
+std::size_t GLLParse::stackNodes() const {
+    return fStack.size();
+}
+
+std::string GLLParse::toDot() const {
+    if (fRoot == -1)
+        return "";
+
+    std::ostringstream dot;
+    dot << "digraph SPPF {" << std::endl;
+
+    // the nodes below the root, each one once
+    std::vector<bool> done(fNodes.size(), false);
+    std::vector<int> todo(1, fRoot);
+    done[fRoot] = true;
+
+    while (!todo.empty()) {
+        const int k = todo.back();
+        todo.pop_back();
+
+        const Node& n = fNodes[k];
+        std::string label;
+
+        if (n.label == EPSILON) {
+            label = "&epsilon;";
+        } else if (n.label >= INTERMEDIATE) {
+            // the rule with the dot
+            const unsigned int slot = n.label - INTERMEDIATE;
+            const unsigned int first = slot - fGrammar.dot(slot);
+
+            label = symbolName(fGrammar.head(slot)) + " ::= ";
+            for (unsigned int s = first; fGrammar.next(s) != EarleyGrammar::COMPLETE; ++s) {
+                if (s == slot)
+                    label += ".";
+
+                label += symbolName(fGrammar.next(s));
+            } // end for
+        } else {
+            label = symbolName(n.label);
+        } // end if-else
+
+        dot << "    n" << k << " [label=\"" << label << ", " << n.left << ", " << n.right << "\""
+            << (n.label >= INTERMEDIATE ? ", shape=box" : "") << "];" << std::endl;
+
+        for (std::size_t p = 0; p < n.packed.size(); ++p) {
+            const Packed& packed = n.packed[p];
+            dot << "    p" << k << "_" << p << " [label=\"\", shape=point];" << std::endl;
+            dot << "    n" << k << " -> p" << k << "_" << p << ";" << std::endl;
+
+            for (const int& child : {packed.left, packed.right}) {
+                if (child == DUMMY)
+                    continue;
+
+                dot << "    p" << k << "_" << p << " -> n" << child << ";" << std::endl;
+
+                if (!done[child]) {
+                    done[child] = true;
+                    todo.push_back(child);
+                } // end if
+            } // end for
+        } // end for
+    } // end while
+
+    dot << "}" << std::endl;
+    return dot.str();
+}
+
+void GLLParse::add(const unsigned int& slot, const unsigned int& stack, const unsigned int& position, const int& node) {
+    // the position follows from the stack node or the forest node
+    const unsigned long long key = (static_cast<unsigned long long>(slot) << 32) | static_cast<unsigned int>(node + 1);
+
+    if (!fStack[stack].descriptors.insert(key).second)
+        return;
+
+    const Descriptor d = {slot, stack, position, node};
+    fDescriptors.push_back(d);
+}
+
+unsigned int GLLParse::create(const unsigned int& slot, const unsigned int& stack, const unsigned int& position, const int& node) {
+    const unsigned long long key = (static_cast<unsigned long long>(slot) << 32) | position;
+    auto it = fStackIndex.find(key);
+
+    unsigned int v;
+    if (it == fStackIndex.end()) {
+        v = fStack.size();
+
+        StackNode created;
+        created.slot = slot;
+        created.position = position;
+        fStack.push_back(created);
+        fStackIndex.insert(std::make_pair(key, v));
+    } else {
+        v = it->second;
+    } // end if-else
+
+    for (const auto& e : fStack[v].edges) {
+        if (e.first == stack && e.second == node)
+            return v;
+    } // end for
+
+    fStack[v].edges.push_back(std::make_pair(stack, node));
+
+    // the variable was already done with before, continue with those
+    // results for the new edge as well
+    for (std::size_t k = 0; k < fStack[v].popped.size(); ++k) {
+        const int popped = fStack[v].popped[k];
+        const int y = this->packedNode(slot, node, popped);
+        this->add(slot, stack, fNodes[popped].right, y);
+    } // end for
+
+    return v;
+}
+
+void GLLParse::pop(const unsigned int& stack, const unsigned int& position, const int& node) {
+    // nothing to return to at the bottom
+    if (stack == 0)
+        return;
+
+    for (const int& p : fStack[stack].popped) {
+        if (p == node)
+            return;
+    } // end for
+
+    fStack[stack].popped.push_back(node);
+
+    for (std::size_t k = 0; k < fStack[stack].edges.size(); ++k) {
+        const std::pair<unsigned int, int> e = fStack[stack].edges[k];
+        const int y = this->packedNode(fStack[stack].slot, e.second, node);
+        this->add(fStack[stack].slot, e.first, position, y);
+    } // end for
+}
+
+int GLLParse::forestNode(const int& label, const unsigned int& left, const unsigned int& right) {
+    const unsigned long long length = fString.size() + 1;
+    const unsigned long long key = (static_cast<unsigned long long>(label) * length + left) * length + right;
+    auto it = fNodeIndex.find(key);
+
+    if (it != fNodeIndex.end())
+        return it->second;
+
+    Node n;
+    n.label = label;
+    n.left = left;
+    n.right = right;
+    fNodes.push_back(n);
+
+    fNodeIndex.insert(std::make_pair(key, static_cast<int>(fNodes.size() - 1)));
+    return fNodes.size() - 1;
+}
+
+int GLLParse::packedNode(const unsigned int& slot, const int& node, const int& child) {
+    const bool complete = fGrammar.next(slot) == EarleyGrammar::COMPLETE;
+
+    // X ::= x.y with y not empty: x itself
+    if (fGrammar.dot(slot) == 1 && !complete)
+        return child;
+
+    const int label = complete ? fGrammar.head(slot) : INTERMEDIATE + static_cast<int>(slot);
+    const unsigned int pivot = fNodes[child].left;
+    const unsigned int left = (node == DUMMY) ? pivot : fNodes[node].left;
+
+    const int y = this->forestNode(label, left, fNodes[child].right);
+
+    for (const Packed& p : fNodes[y].packed) {
+        if (p.slot == slot && p.pivot == pivot)
+            return y;
+    } // end for
+
+    const Packed p = {slot, pivot, node, child};
+    fNodes[y].packed.push_back(p);
+    ++fPacked;
+
+    return y;
+}
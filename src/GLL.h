@@ -0,0 +1,189 @@
+/* GLL
+ * Interface declaration of a generalized LL parser building a shared packed
+ * parse forest.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_GLL_H
+#define H_GLL_H
+
+#include "Earley.h"
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief GLL parse (Scott and Johnstone) of a string, on the production
+ * rules of a CFG as they are. The grammar slots are the dotted rules of an
+ * EarleyGrammar.
+ *
+ * Instead of one stack per alternative (as the breadth first search of the
+ * PDA does), the parser keeps one graph structured stack (GSS): a node for
+ * each return slot and position, shared by all alternatives that call the
+ * same variable at the same position. All parse trees are kept in one
+ * binarized shared packed parse forest (SPPF), with at most cubically many
+ * nodes in the length of the string:
+ * - a symbol node (X, i, j) for X deriving the substring from i up to j,
+ * - an intermediate node (slot, i, j) for the symbols before the dot of a
+ *   slot deriving the substring from i up to j,
+ * - the packed nodes of a symbol or intermediate node, one for each way to
+ *   split it into a left part (an intermediate node, if any) and a right
+ *   part (the last symbol).
+ */
+class GLLParse {
+public:
+    /**
+     * @brief The label of epsilon nodes, symbol nodes have the symbol (as
+     * unsigned char, 256 for S') as label.
+     */
+    static const int EPSILON = 257;
+
+    /**
+     * @brief The label of the intermediate node of slot 0, the other slots
+     * follow.
+     */
+    static const int INTERMEDIATE = 258;
+
+    /**
+     * @brief A way to split a node: the slot, the position of the split, and
+     * the left child (-1 if there is none) and the right child.
+     */
+    struct Packed {
+        unsigned int slot;
+        unsigned int pivot;
+        int left;
+        int right;
+    };
+
+    /**
+     * @brief A node of the forest, the label and the substring from left up
+     * to right it derives.
+     */
+    struct Node {
+        int label;
+        unsigned int left;
+        unsigned int right;
+        std::vector<Packed> packed;
+    };
+
+    /**
+     * @brief Constructor, parses the string.
+     *
+     * @param grammar The compiled CFG.
+     * @param str The string to be parsed.
+     *
+     * @throw std::invalid_argument if the string contains symbols that are
+     * not terminals of the grammar.
+     */
+    GLLParse(const EarleyGrammar& grammar, const std::string& str);
+
+    /**
+     * @brief Check whether the string is in the language of the grammar.
+     */
+    bool accepted() const;
+
+    /**
+     * @brief Get the node (S, 0, length) of the start symbol S.
+     *
+     * @return The index of the node, -1 if the string isn't accepted.
+     */
+    int root() const;
+
+    /**
+     * @brief Get the amount of nodes of the forest (without the packed
+     * nodes).
+     */
+    std::size_t nodes() const;
+
+    /**
+     * @brief Get the amount of packed nodes of the forest.
+     */
+    std::size_t packedNodes() const;
+
+    /**
+     * @brief Get a node of the forest.
+     */
+    const Node& node(const std::size_t& k) const;
+
+    /**
+     * @brief Get the amount of nodes of the graph structured stack.
+     */
+    std::size_t stackNodes() const;
+
+    /**
+     * @brief Get the part of the forest below the root in the Graphviz dot
+     * format, empty if the string isn't accepted.
+     */
+    std::string toDot() const;
+
+private:
+    // a node of the graph structured stack, the slot to return to and the
+    // position it was created at
+    struct StackNode {
+        unsigned int slot;
+        unsigned int position;
+
+        // the edges to the nodes below, with the forest node so far
+        std::vector< std::pair<unsigned int, int> > edges;
+
+        // the forest nodes it was popped with
+        std::vector<int> popped;
+
+        // the descriptors (slot, forest node) that were added for this node
+        std::unordered_set<unsigned long long> descriptors;
+    };
+
+    // a slot, stack node, position and forest node to continue with
+    struct Descriptor {
+        unsigned int slot;
+        unsigned int stack;
+        unsigned int position;
+        int node;
+    };
+
+    void add(const unsigned int& slot, const unsigned int& stack, const unsigned int& position, const int& node);
+
+    unsigned int create(const unsigned int& slot, const unsigned int& stack, const unsigned int& position, const int& node);
+
+    void pop(const unsigned int& stack, const unsigned int& position, const int& node);
+
+    // the forest node with the label and extents, created if needed
+    int forestNode(const int& label, const unsigned int& left, const unsigned int& right);
+
+    // the forest node for the symbols before the dot of the slot, with node
+    // the one for the symbols before the last of these and child the one
+    // for the last symbol
+    int packedNode(const unsigned int& slot, const int& node, const int& child);
+
+    const EarleyGrammar& fGrammar;
+    std::string fString;
+
+    std::vector<StackNode> fStack;
+    std::unordered_map<unsigned long long, unsigned int> fStackIndex;
+
+    std::vector<Node> fNodes;
+    std::unordered_map<unsigned long long, int> fNodeIndex;
+    std::size_t fPacked;
+
+    std::vector<Descriptor> fDescriptors;
+
+    int fRoot;
+};
+
+#endif // H_GLL_H
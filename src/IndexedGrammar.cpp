@@ -0,0 +1,703 @@
+/* IndexedGrammar
+ * Interface definition of a context free grammar with integer symbols.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "IndexedGrammar.h"
+#include "CFG.h"
+#include "CNF.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// the amount of terminal symbols, the variables come after them
+const Symbol TERMINALS = 256;
+
+// the log weight of something that can't be derived
+const double NONE = -std::numeric_limits<double>::infinity();
+
+// a variable with the best log weight found so far, best first
+typedef std::pair<double, unsigned int> Candidate;
+typedef std::priority_queue<Candidate> Candidates;
+
+} // end namespace
+
+IndexedGrammar::IndexedGrammar()
+    : fTerminals(TERMINALS, false), fStart(0), fHasStart(false), fOffsets(1, 0) {
+}
+
+IndexedGrammar::IndexedGrammar(const CFG& cfg) : IndexedGrammar() {
+    // the variable of each character, if any
+    std::vector<int> variables(TERMINALS, -1);
+
+    for (const char& t : cfg.getTerminals()) {
+        this->addTerminal(t);
+    } // end for
+
+    for (const char& v : cfg.getVariables()) {
+        variables.at(static_cast<unsigned char>(v)) = this->addVariable(v);
+    } // end for
+
+    for (const auto& p : cfg.getProductions()) {
+        const int head = variables.at(static_cast<unsigned char>(p.first));
+
+        if (head < 0)
+            throw std::invalid_argument("Invalid production rule.");
+
+        std::vector<Symbol> body;
+        for (const char& s : p.second) {
+            const int v = variables.at(static_cast<unsigned char>(s));
+            body.push_back(v < 0 ? terminal(s) : Symbol(v));
+        } // end for
+
+        this->addProduction(head, body);
+    } // end for
+
+    const int start = variables.at(static_cast<unsigned char>(cfg.getStartsymbol()));
+    if (start >= 0)
+        this->setStart(start);
+
+    fStats = cfg.getStats();
+}
+
+IndexedGrammar::IndexedGrammar(const CFG& cfg, const ProductionWeights& weights) : IndexedGrammar(cfg) {
+    if (weights.empty())
+        return;
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    // the production rules were added in the order of the CFG
+    std::size_t p = 0;
+
+    for (const auto& r : cfg.getProductions()) {
+        auto it = weights.find(std::pair<char, SymbolString>(r.first, r.second));
+
+        if (it != weights.end()) {
+            // a probability, so a cycle of rules can't gain weight
+            if (!(it->second > 0) || it->second > 1)
+                throw std::invalid_argument("Invalid production weight.");
+
+            fWeights.at(p) = std::log(it->second);
+        } // end if
+
+        ++p;
+    } // end for
+
+    this->recordStage("weights", begin);
+}
+
+IndexedGrammar::IndexedGrammar(const CNF& cnf) : IndexedGrammar(static_cast<const CFG&>(cnf)) {
+    if (!cnf.isWeighted())
+        return;
+
+    // the names are the original characters
+    for (std::size_t p = 0; p < this->productions(); ++p) {
+        SymbolString body;
+
+        for (unsigned int k = 0; k < this->bodySize(p); ++k) {
+            const Symbol& s = this->body(p)[k];
+            body += isTerminal(s) ? toTerminal(s) : this->name(s);
+        } // end for
+
+        fWeights.at(p) = cnf.weight(this->name(fHeads.at(p)), body);
+    } // end for
+}
+
+bool IndexedGrammar::isTerminal(const Symbol& s) {
+    return s < TERMINALS;
+}
+
+Symbol IndexedGrammar::terminal(const char& t) {
+    return static_cast<unsigned char>(t);
+}
+
+Symbol IndexedGrammar::variable(const unsigned int& index) {
+    return TERMINALS + index;
+}
+
+char IndexedGrammar::toTerminal(const Symbol& s) {
+    return static_cast<char>(s);
+}
+
+unsigned int IndexedGrammar::toIndex(const Symbol& v) {
+    return v - TERMINALS;
+}
+
+void IndexedGrammar::addTerminal(const char& t) {
+    fTerminals.at(static_cast<unsigned char>(t)) = true;
+}
+
+bool IndexedGrammar::hasTerminal(const char& t) const {
+    return fTerminals.at(static_cast<unsigned char>(t));
+}
+
+Symbol IndexedGrammar::addVariable(const char& name) {
+    fNames.push_back(name);
+
+    return variable(fNames.size() - 1);
+}
+
+unsigned int IndexedGrammar::variables() const {
+    return fNames.size();
+}
+
+char IndexedGrammar::name(const Symbol& v) const {
+    return fNames.at(toIndex(v));
+}
+
+void IndexedGrammar::setStart(const Symbol& v) {
+    if (isTerminal(v) || toIndex(v) >= fNames.size())
+        throw std::invalid_argument("The start symbol is not a variable.");
+
+    fStart = v;
+    fHasStart = true;
+}
+
+bool IndexedGrammar::hasStart() const {
+    return fHasStart;
+}
+
+Symbol IndexedGrammar::start() const {
+    return fStart;
+}
+
+void IndexedGrammar::addProduction(const Symbol& head, const std::vector<Symbol>& body, const double& weight) {
+    if (isTerminal(head) || toIndex(head) >= fNames.size())
+        throw std::invalid_argument("The head of a production rule must be a variable.");
+
+    for (const Symbol& s : body) {
+        if (isTerminal(s) ? !this->hasTerminal(toTerminal(s)) : toIndex(s) >= fNames.size())
+            throw std::invalid_argument("Invalid symbol in the body of a production rule.");
+    } // end for
+
+    // the weight of a probability, so a cycle of rules can't gain weight
+    if (!(weight <= 0))
+        throw std::invalid_argument("Invalid production weight.");
+
+    this->push(head, body.data(), body.data() + body.size(), weight);
+}
+
+std::size_t IndexedGrammar::productions() const {
+    return fHeads.size();
+}
+
+Symbol IndexedGrammar::head(const std::size_t& p) const {
+    return fHeads.at(p);
+}
+
+const Symbol* IndexedGrammar::body(const std::size_t& p) const {
+    return fBodies.data() + fOffsets.at(p);
+}
+
+unsigned int IndexedGrammar::bodySize(const std::size_t& p) const {
+    return fOffsets.at(p + 1) - fOffsets.at(p);
+}
+
+double IndexedGrammar::weight(const std::size_t& p) const {
+    return fWeights.at(p);
+}
+
+bool IndexedGrammar::isCNF() const {
+    for (std::size_t p = 0; p < this->productions(); ++p) {
+        const Symbol* b = this->body(p);
+
+        if (this->bodySize(p) == 1 && isTerminal(b[0]))
+            continue;
+
+        if (this->bodySize(p) == 2 && !isTerminal(b[0]) && !isTerminal(b[1]))
+            continue;
+
+        return false;
+    } // end for
+
+    return true;
+}
+
+void IndexedGrammar::cleanUp(const EpsilonElimination& mode, const UnitElimination& unitMode) {
+    // this one is easy now, just clean up in this order
+    auto begin = std::chrono::steady_clock::now();
+    this->eleminateEpsilonProductions(mode);
+    this->recordStage("epsilon", begin);
+
+    begin = std::chrono::steady_clock::now();
+    this->eleminateUnitProductions(unitMode);
+    this->recordStage("unit", begin);
+
+    begin = std::chrono::steady_clock::now();
+    this->eleminateUselessSymbols();
+    this->recordStage("useless", begin);
+}
+
+void IndexedGrammar::toCNF(const EpsilonElimination& mode, const Binarization& binarization) {
+    this->cleanUp(mode);
+
+    auto begin = std::chrono::steady_clock::now();
+    IndexedGrammar old(*this);
+    this->clearProductions();
+
+    // the variable A with A --> a for each terminal a, introduced when needed
+    std::vector<Symbol> terms(TERMINALS, 0);
+
+    for (std::size_t p = 0; p < old.productions(); ++p) {
+        const Symbol* b = old.body(p);
+        const unsigned int size = old.bodySize(p);
+
+        // after cleaning up, a body of one symbol must be a terminal
+        if (size == 1) {
+            this->push(old.head(p), b, b + 1, old.weight(p));
+            continue;
+        } // end if
+
+        // replace the terminals by variables
+        std::vector<Symbol> body(b, b + size);
+
+        for (Symbol& s : body) {
+            if (!isTerminal(s))
+                continue;
+
+            if (terms.at(s) == 0) {
+                terms.at(s) = this->addVariable();
+                this->push(terms.at(s), &s, &s + 1, 0);
+            } // end if
+
+            s = terms.at(s);
+        } // end for
+
+        this->push(old.head(p), body.data(), body.data() + body.size(), old.weight(p));
+    } // end for
+
+    this->recordStage("terminals", begin);
+
+    begin = std::chrono::steady_clock::now();
+    old = *this;
+    this->clearProductions();
+
+    // the variable V --> XY of each prefix XY, when sharing them
+    std::map<std::pair<Symbol, Symbol>, Symbol> prefixes;
+
+    for (std::size_t p = 0; p < old.productions(); ++p) {
+        const Symbol* body = old.body(p);
+        const unsigned int size = old.bodySize(p);
+
+        if (size <= 2) {
+            this->push(old.head(p), body, body + size, old.weight(p));
+            continue;
+        } // end if
+
+        // ABCDE becomes ((((AB)C)D)E)
+        Symbol pair[2] = {body[0], 0};
+
+        for (unsigned int k = 1; k + 1 < size; ++k) {
+            pair[1] = body[k];
+
+            const std::pair<Symbol, Symbol> prefix(pair[0], pair[1]);
+            auto shared = prefixes.find(prefix);
+
+            if (binarization == BINARIZE_SHARED && shared != prefixes.end()) {
+                pair[0] = shared->second;
+                continue;
+            } // end if
+
+            const Symbol v = this->addVariable();
+            this->push(v, pair, pair + 2, 0);
+            prefixes[prefix] = v;
+
+            pair[0] = v;
+        } // end for
+
+        pair[1] = body[size - 1];
+        this->push(old.head(p), pair, pair + 2, old.weight(p));
+    } // end for
+
+    this->sortProductions();
+    this->recordStage("binarize", begin);
+}
+
+const GrammarStats& IndexedGrammar::stats() const {
+    return fStats;
+}
+
+void IndexedGrammar::clearProductions() {
+    fHeads.clear();
+    fOffsets.assign(1, 0);
+    fBodies.clear();
+    fWeights.clear();
+}
+
+void IndexedGrammar::push(const Symbol& head, const Symbol* first, const Symbol* last, const double& weight) {
+    fHeads.push_back(head);
+    fBodies.insert(fBodies.end(), first, last);
+    fOffsets.push_back(fBodies.size());
+    fWeights.push_back(weight);
+}
+
+void IndexedGrammar::sortProductions() {
+    std::vector<std::size_t> order(this->productions());
+    for (std::size_t p = 0; p < order.size(); ++p) {
+        order[p] = p;
+    } // end for
+
+    const IndexedGrammar old(*this);
+
+    const auto less = [&](const std::size_t& p, const std::size_t& q) {
+        if (old.head(p) != old.head(q))
+            return old.head(p) < old.head(q);
+
+        return std::lexicographical_compare(
+                    old.body(p), old.body(p) + old.bodySize(p),
+                    old.body(q), old.body(q) + old.bodySize(q)
+                    );
+    };
+
+    std::sort(order.begin(), order.end(), less);
+
+    this->clearProductions();
+
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        const std::size_t& p = order[k];
+
+        // a duplicate of the last rule
+        if (k > 0 && !less(order[k-1], p)) {
+            fWeights.back() = std::max(fWeights.back(), old.weight(p));
+            continue;
+        } // end if
+
+        this->push(old.head(p), old.body(p), old.body(p) + old.bodySize(p), old.weight(p));
+    } // end for
+}
+
+std::vector<std::size_t> IndexedGrammar::firstProductions() const {
+    std::vector<std::size_t> first(fNames.size() + 1, 0);
+
+    for (const Symbol& h : fHeads) {
+        ++first.at(toIndex(h) + 1);
+    } // end for
+
+    for (std::size_t v = 1; v < first.size(); ++v) {
+        first[v] += first[v-1];
+    } // end for
+
+    return first;
+}
+
+std::vector<double> IndexedGrammar::emptyWeights() const {
+    // Knuth's generalization of Dijkstra: a rule is used as soon as all the
+    // variables of its body have their best weight
+    std::vector<double> best(fNames.size(), NONE);
+    std::vector<bool> done(fNames.size(), false);
+
+    // for each rule the amount of variables that aren't done, and the sum
+    // of the weights of those that are
+    std::vector<unsigned int> remaining(this->productions(), 0);
+    std::vector<double> sum(fWeights);
+
+    // for each variable the rules it occurs in (once for each occurrence)
+    std::vector< std::vector<std::size_t> > occurrences(fNames.size());
+
+    Candidates candidates;
+
+    for (std::size_t p = 0; p < this->productions(); ++p) {
+        const Symbol* b = this->body(p);
+        bool terminal = false;
+
+        for (unsigned int k = 0; k < this->bodySize(p); ++k) {
+            terminal = terminal || isTerminal(b[k]);
+        } // end for
+
+        // never derives the empty string
+        if (terminal)
+            continue;
+
+        for (unsigned int k = 0; k < this->bodySize(p); ++k) {
+            occurrences.at(toIndex(b[k])).push_back(p);
+        } // end for
+
+        remaining[p] = this->bodySize(p);
+        if (remaining[p] == 0)
+            candidates.push(Candidate(fWeights[p], toIndex(fHeads[p])));
+    } // end for
+
+    while (!candidates.empty()) {
+        const Candidate c = candidates.top();
+        candidates.pop();
+
+        if (done[c.second])
+            continue;
+
+        done[c.second] = true;
+        best[c.second] = c.first;
+
+        for (const std::size_t& p : occurrences[c.second]) {
+            sum[p] += c.first;
+
+            if (--remaining[p] == 0 && !done[toIndex(fHeads[p])])
+                candidates.push(Candidate(sum[p], toIndex(fHeads[p])));
+        } // end for
+    } // end while
+
+    return best;
+}
+
+void IndexedGrammar::eleminateEpsilonProductions(const EpsilonElimination& mode) {
+    std::vector<double> empty = this->emptyWeights();
+
+    if (mode == EPSILON_BINARIZED) {
+        // split the bodies with more than two nullable symbols, just as
+        // CFG::eleminateEpsilonProductions
+        const IndexedGrammar old(*this);
+        this->clearProductions();
+
+        for (std::size_t p = 0; p < old.productions(); ++p) {
+            const Symbol* b = old.body(p);
+            const unsigned int size = old.bodySize(p);
+            unsigned int count = 0;
+
+            for (unsigned int k = 0; k < size; ++k) {
+                if (!isTerminal(b[k]) && empty.at(toIndex(b[k])) != NONE)
+                    ++count;
+            } // end for
+
+            if (count <= 2) {
+                this->push(old.head(p), b, b + size, old.weight(p));
+                continue;
+            } // end if
+
+            Symbol head = old.head(p);
+            double weight = old.weight(p);
+
+            for (unsigned int k = 0; k + 2 < size; ++k) {
+                const Symbol pair[2] = {b[k], this->addVariable()};
+                this->push(head, pair, pair + 2, weight);
+
+                head = pair[1];
+                weight = 0;
+            } // end for
+
+            this->push(head, b + size - 2, b + size, 0);
+        } // end for
+
+        // the new variables for nullable suffixes are nullable too
+        empty = this->emptyWeights();
+    } // end if
+
+    const IndexedGrammar old(*this);
+    this->clearProductions();
+
+    for (std::size_t p = 0; p < old.productions(); ++p) {
+        // all the bodies from leaving out nullable symbols or not
+        std::vector< std::pair<std::vector<Symbol>, double> > bodies(1);
+        bodies.front().second = old.weight(p);
+
+        for (unsigned int k = 0; k < old.bodySize(p); ++k) {
+            const Symbol& s = old.body(p)[k];
+            const bool nullable = !isTerminal(s) && empty.at(toIndex(s)) != NONE;
+            const std::size_t size = bodies.size();
+
+            for (std::size_t b = 0; b < size; ++b) {
+                if (nullable) {
+                    bodies.push_back(bodies[b]);
+                    bodies.back().second += empty.at(toIndex(s));
+                } // end if
+
+                bodies[b].first.push_back(s);
+            } // end for
+        } // end for
+
+        for (const auto& b : bodies) {
+            // skip if the body is empty
+            if (b.first.empty())
+                continue;
+
+            this->push(old.head(p), b.first.data(), b.first.data() + b.first.size(), b.second);
+        } // end for
+    } // end for
+
+    this->sortProductions();
+}
+
+void IndexedGrammar::eleminateUnitProductions(const UnitElimination& mode) {
+    const IndexedGrammar old(*this);
+    const std::vector<std::size_t> first = old.firstProductions();
+    this->clearProductions();
+
+    // the best weight of the unit pairs (A, B) for one A at a time
+    std::vector<double> best(fNames.size(), NONE);
+    std::vector<bool> done(fNames.size(), false);
+    std::vector<unsigned int> touched;
+
+    for (unsigned int a = 0; a < fNames.size(); ++a) {
+        Candidates candidates;
+        candidates.push(Candidate(0, a));
+        best[a] = 0;
+        touched.push_back(a);
+
+        while (!candidates.empty()) {
+            const Candidate c = candidates.top();
+            candidates.pop();
+
+            const unsigned int& b = c.second;
+            if (done[b])
+                continue;
+
+            done[b] = true;
+
+            for (std::size_t p = first[b]; p < first[b + 1]; ++p) {
+                const Symbol* body = old.body(p);
+                const double w = c.first + old.weight(p);
+
+                if (old.bodySize(p) == 1 && !isTerminal(body[0])) {
+                    // unit production B --> C, so (A, C) is a unit pair
+                    const unsigned int to = toIndex(body[0]);
+
+                    if (mode == UNITS_ACYCLIC && to == a) {
+                        *this = old;
+                        throw std::runtime_error("Cyclic unit pairs detected.");
+                    } // end if
+
+                    if (!done[to] && w > best[to]) {
+                        if (best[to] == NONE)
+                            touched.push_back(to);
+
+                        best[to] = w;
+                        candidates.push(Candidate(w, to));
+                    } // end if
+                } else {
+                    // A --> body for each non-unit rule B --> body
+                    this->push(variable(a), body, body + old.bodySize(p), w);
+                } // end if-else
+            } // end for
+        } // end while
+
+        for (const unsigned int& v : touched) {
+            best[v] = NONE;
+            done[v] = false;
+        } // end for
+
+        touched.clear();
+    } // end for
+
+    this->sortProductions();
+}
+
+void IndexedGrammar::eleminateUselessSymbols() {
+    // generating variables, just as the nullable ones but terminals count
+    std::vector<bool> generating(fNames.size(), false);
+    std::vector<unsigned int> remaining(this->productions(), 0);
+    std::vector< std::vector<std::size_t> > occurrences(fNames.size());
+    std::vector<unsigned int> queue;
+
+    for (std::size_t p = 0; p < this->productions(); ++p) {
+        for (unsigned int k = 0; k < this->bodySize(p); ++k) {
+            const Symbol& s = this->body(p)[k];
+
+            if (!isTerminal(s)) {
+                occurrences.at(toIndex(s)).push_back(p);
+                ++remaining[p];
+            } // end if
+        } // end for
+
+        if (remaining[p] == 0)
+            queue.push_back(toIndex(fHeads[p]));
+    } // end for
+
+    while (!queue.empty()) {
+        const unsigned int v = queue.back();
+        queue.pop_back();
+
+        if (generating[v])
+            continue;
+
+        generating[v] = true;
+
+        for (const std::size_t& p : occurrences[v]) {
+            if (--remaining[p] == 0)
+                queue.push_back(toIndex(fHeads[p]));
+        } // end for
+    } // end while
+
+    // only keep the rules with generating symbols
+    const IndexedGrammar old(*this);
+    this->clearProductions();
+
+    for (std::size_t p = 0; p < old.productions(); ++p) {
+        if (remaining[p] == 0)
+            this->push(old.head(p), old.body(p), old.body(p) + old.bodySize(p), old.weight(p));
+    } // end for
+
+    // reachable variables from the start symbol
+    std::vector<bool> reachable(fNames.size(), false);
+    const std::vector<std::size_t> first = this->firstProductions();
+
+    if (fHasStart) {
+        queue.push_back(toIndex(fStart));
+        reachable.at(toIndex(fStart)) = true;
+    } // end if
+
+    while (!queue.empty()) {
+        const unsigned int v = queue.back();
+        queue.pop_back();
+
+        for (std::size_t p = first[v]; p < first[v + 1]; ++p) {
+            for (unsigned int k = 0; k < this->bodySize(p); ++k) {
+                const Symbol& s = this->body(p)[k];
+
+                if (!isTerminal(s) && !reachable[toIndex(s)]) {
+                    reachable[toIndex(s)] = true;
+                    queue.push_back(toIndex(s));
+                } // end if
+            } // end for
+        } // end for
+    } // end while
+
+    // only keep the rules with a reachable head
+    const IndexedGrammar generated(*this);
+    this->clearProductions();
+
+    for (std::size_t p = 0; p < generated.productions(); ++p) {
+        if (reachable[toIndex(generated.head(p))])
+            this->push(generated.head(p), generated.body(p), generated.body(p) + generated.bodySize(p), generated.weight(p));
+    } // end for
+}
+
+void IndexedGrammar::recordStage(const std::string& stage, const std::chrono::steady_clock::time_point& begin) {
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+    StageStats stats;
+    stats.stage = stage;
+    stats.variables = 0;
+    stats.productions = this->productions();
+    stats.symbols = fBodies.size();
+    stats.seconds = elapsed.count();
+
+    // only the variables with production rules, just as a cleaned up CFG
+    std::vector<bool> heads(fNames.size(), false);
+
+    for (const Symbol& h : fHeads) {
+        if (!heads[toIndex(h)])
+            ++stats.variables;
+
+        heads[toIndex(h)] = true;
+    } // end for
+
+    fStats.stages.push_back(stats);
+}
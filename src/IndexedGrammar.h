@@ -0,0 +1,318 @@
+/* IndexedGrammar
+ * Interface declaration of a context free grammar with integer symbols.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_INDEXEDGRAMMAR_H
+#define H_INDEXEDGRAMMAR_H
+
+#include "CFG.h"
+#include "CNF.h"
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A symbol of an IndexedGrammar. The terminals are still characters,
+ * so the symbols below 256 are the terminals (as unsigned char) and the
+ * variables are numbered from 256 on. Use IndexedGrammar::terminal() and
+ * IndexedGrammar::variable() to convert.
+ */
+typedef unsigned int Symbol;
+
+/**
+ * @brief A context free grammar just as CFG, but the variables are dense
+ * integers instead of characters (so there's no limit of 256 variables) and
+ * the production rules are stored in flat arrays: one array of heads and
+ * all the bodies one after the other.
+ *
+ * This is where grammars are cleaned up and converted to Chomsky Normal
+ * Form: CFG::cleanUp() (and the separate steps) and the constructor of CNF
+ * convert to an IndexedGrammar, run the steps below and convert back. A
+ * production rule may have a log weight, see CNF::weight().
+ */
+class IndexedGrammar {
+public:
+    /**
+     * @brief Constructor, an empty grammar without start symbol.
+     */
+    IndexedGrammar();
+
+    /**
+     * @brief Constructor, copy the symbols, production rules and stats of a
+     * CFG. The variables keep their character as name.
+     */
+    explicit IndexedGrammar(const CFG& cfg);
+
+    /**
+     * @brief Constructor, copy a CFG just as above, with the passed weights
+     * (as probabilities) for its production rules, see CNF. This is
+     * recorded as the stage "weights" if there are any weights.
+     *
+     * @throw std::invalid_argument if a weight is not positive or above 1.
+     */
+    IndexedGrammar(const CFG& cfg, const ProductionWeights& weights);
+
+    /**
+     * @brief Constructor, copy the symbols, production rules and weights of
+     * a CNF.
+     */
+    explicit IndexedGrammar(const CNF& cnf);
+
+    /**
+     * @brief Check whether the symbol is a terminal.
+     */
+    static bool isTerminal(const Symbol& s);
+
+    /**
+     * @brief Get the symbol of a terminal.
+     */
+    static Symbol terminal(const char& t);
+
+    /**
+     * @brief Get the symbol of the variable with the passed index.
+     */
+    static Symbol variable(const unsigned int& index);
+
+    /**
+     * @brief Get the terminal of a symbol.
+     *
+     * @pre isTerminal(s)
+     */
+    static char toTerminal(const Symbol& s);
+
+    /**
+     * @brief Get the index of a variable (from 0 to variables() - 1).
+     *
+     * @pre !isTerminal(v)
+     */
+    static unsigned int toIndex(const Symbol& v);
+
+    /**
+     * @brief Add a terminal.
+     */
+    void addTerminal(const char& t);
+
+    /**
+     * @brief Check whether the character is a terminal of this grammar.
+     */
+    bool hasTerminal(const char& t) const;
+
+    /**
+     * @brief Add a new variable.
+     *
+     * @param name The character of the variable, if any. Names are only
+     * used to show the variable, they don't have to be unique.
+     *
+     * @return The new variable.
+     */
+    Symbol addVariable(const char& name = 0);
+
+    /**
+     * @brief Get the amount of variables.
+     */
+    unsigned int variables() const;
+
+    /**
+     * @brief Get the name of a variable, 0 if it has none.
+     */
+    char name(const Symbol& v) const;
+
+    /**
+     * @brief Set the start symbol.
+     *
+     * @throw std::invalid_argument if the symbol is not a variable of this
+     * grammar.
+     */
+    void setStart(const Symbol& v);
+
+    /**
+     * @brief Check whether a start symbol was set.
+     */
+    bool hasStart() const;
+
+    /**
+     * @brief Get the start symbol.
+     *
+     * @pre hasStart()
+     */
+    Symbol start() const;
+
+    /**
+     * @brief Add a production rule head --> body.
+     *
+     * @param head The head, a variable.
+     * @param body The body, terminals of this grammar and variables.
+     * @param weight The log weight of the rule, at most 0.
+     *
+     * @throw std::invalid_argument if the head is not a variable, the body
+     * contains unknown symbols or the weight is above 0 (or not a number).
+     */
+    void addProduction(const Symbol& head, const std::vector<Symbol>& body, const double& weight = 0);
+
+    /**
+     * @brief Get the amount of production rules.
+     */
+    std::size_t productions() const;
+
+    /**
+     * @brief Get the head of the production rule with the passed index.
+     */
+    Symbol head(const std::size_t& p) const;
+
+    /**
+     * @brief Get the first symbol of the body of a production rule, the
+     * other symbols follow.
+     */
+    const Symbol* body(const std::size_t& p) const;
+
+    /**
+     * @brief Get the size of the body of a production rule.
+     */
+    unsigned int bodySize(const std::size_t& p) const;
+
+    /**
+     * @brief Get the log weight of a production rule.
+     */
+    double weight(const std::size_t& p) const;
+
+    /**
+     * @brief Check whether all production rules are of the form A --> BC or
+     * A --> a.
+     */
+    bool isCNF() const;
+
+    /**
+     * @brief Eleminate epsilon productions, see
+     * CFG::eleminateEpsilonProductions(). A rule that comes from leaving out
+     * nullable symbols gets the best log weight of deriving the empty string
+     * from them.
+     *
+     * @param mode How to eleminate them.
+     *
+     * @post The production rules are sorted on their head.
+     */
+    void eleminateEpsilonProductions(const EpsilonElimination& mode = EPSILON_SUBSETS);
+
+    /**
+     * @brief Eleminate unit productions, see
+     * CFG::eleminateUnitProductions(). A rule that replaces a chain of unit
+     * productions gets the log weight of the best chain.
+     *
+     * @param mode With UNITS_CONDENSED cycles of unit productions are
+     * allowed.
+     *
+     * @throw std::runtime_error When there are cyclic unit pairs and the mode
+     * is UNITS_ACYCLIC, the grammar is left as it was.
+     *
+     * @post The production rules are sorted on their head.
+     */
+    void eleminateUnitProductions(const UnitElimination& mode = UNITS_CONDENSED);
+
+    /**
+     * @brief Eleminate the production rules with symbols that are not
+     * generating or a head that is not reachable, see
+     * CFG::eleminateUselessSymbols(). The variables stay.
+     */
+    void eleminateUselessSymbols();
+
+    /**
+     * @brief Eleminate epsilon productions, unit productions and useless
+     * symbols, just as CFG::cleanUp(). The steps are recorded as the stages
+     * "epsilon", "unit" and "useless".
+     *
+     * @param mode How to eleminate the epsilon productions.
+     * @param unitMode How to eleminate the unit productions.
+     *
+     * @throw std::runtime_error When there are cyclic unit pairs and the mode
+     * is UNITS_ACYCLIC.
+     *
+     * @post The production rules are sorted on their head.
+     */
+    void cleanUp(
+        const EpsilonElimination& mode = EPSILON_SUBSETS,
+        const UnitElimination& unitMode = UNITS_CONDENSED
+        );
+
+    /**
+     * @brief Clean up and convert to Chomsky Normal Form, for the
+     * constructor of CNF. Rules that are introduced get log weight 0. After
+     * the stages of cleanUp(), replacing the terminals in long bodies and
+     * splitting those bodies are recorded as "terminals" and "binarize".
+     *
+     * @param mode How to eleminate the epsilon productions.
+     * @param binarization How to split long bodies.
+     *
+     * @post isCNF()
+     */
+    void toCNF(
+        const EpsilonElimination& mode = EPSILON_BINARIZED,
+        const Binarization& binarization = BINARIZE_SHARED
+        );
+
+    /**
+     * @brief Get the size of the grammar after each stage so far, starting
+     * with the stages of the CFG it was copied from. The variables of a
+     * stage are the ones with production rules.
+     */
+    const GrammarStats& stats() const;
+
+private:
+    // remove all production rules
+    void clearProductions();
+
+    // add a production rule without checking it
+    void push(const Symbol& head, const Symbol* first, const Symbol* last, const double& weight);
+
+    // sort the production rules on head and body, for duplicates keep the
+    // best weight
+    void sortProductions();
+
+    // for each variable the index of its first production rule, and one
+    // past the last for the last variable
+    // @pre the production rules are sorted
+    std::vector<std::size_t> firstProductions() const;
+
+    // for each variable the best log weight of deriving the empty string
+    std::vector<double> emptyWeights() const;
+
+    // add the current size of the grammar to the stats, as the result of a
+    // stage that started at begin
+    void recordStage(const std::string& stage, const std::chrono::steady_clock::time_point& begin);
+
+    // for each (unsigned char) terminal whether it's in the grammar
+    std::vector<bool> fTerminals;
+
+    // the name of each variable
+    std::vector<char> fNames;
+
+    Symbol fStart;
+
+    bool fHasStart;
+
+    // the production rules: heads, offsets of the bodies in fBodies (one
+    // more than there are rules) and log weights
+    std::vector<Symbol> fHeads;
+    std::vector<std::size_t> fOffsets;
+    std::vector<Symbol> fBodies;
+    std::vector<double> fWeights;
+
+    GrammarStats fStats;
+};
+
+#endif // H_INDEXEDGRAMMAR_H
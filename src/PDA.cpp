@@ -21,6 +21,7 @@
  */
 
 #include "PDA.h"
+#include <unordered_set>
 
 PDAState::PDAState(std::string name){
 	this->fName = name;
@@ -87,43 +88,108 @@ PDATransition::PDATransition(PDAState* from, PDAState* to, const char& input, co
 	this->fStackOperation = stackOperation;
 }
 
-void PDATransition::stackOperation(std::stack<char>& in){
-	if(this->fStackOperation == PUSH){
-		for(auto pushStackIt = this->fPushStack.begin(); pushStackIt != this->fPushStack.end();pushStackIt++){
+PDAStack::PDAStack(PDAStackArena& arena){
+	this->fArena = &arena;
+	this->fTop = -1;
+	this->fSize = 0;
+}
+
+PDAStack::PDAStack(PDAStackArena& arena, const std::stack<char>& stack){
+	this->fArena = &arena;
+	this->fTop = -1;
+	this->fSize = 0;
+
+	// push from the bottom up
+	std::vector<char> symbols;
+	for(std::stack<char> temp = stack; !temp.empty(); temp.pop()){
+		symbols.push_back(temp.top());
+	}
+
+	for(auto symbolIt = symbols.rbegin(); symbolIt != symbols.rend(); symbolIt++){
+		this->push(*symbolIt);
+	}
+}
+
+void PDAStack::push(const char& symbol){
+	this->fTop = this->fArena->cons(symbol, this->fTop);
+	this->fSize++;
+}
+
+void PDAStack::pop(){
+	this->fTop = this->fArena->below(this->fTop);
+	this->fSize--;
+}
+
+char PDAStack::top() const{
+	return this->fArena->symbol(this->fTop);
+}
+
+std::size_t PDAStack::size() const{
+	return this->fSize;
+}
+
+bool PDAStack::empty() const{
+	return this->fSize == 0;
+}
+
+int PDAStack::cell() const{
+	return this->fTop;
+}
+
+std::stack<char> PDAStack::toStack() const{
+	std::vector<char> symbols;
+	for(int cell = this->fTop; cell != -1; cell = this->fArena->below(cell)){
+		symbols.push_back(this->fArena->symbol(cell));
+	}
+
+	std::stack<char> stack;
+	for(auto symbolIt = symbols.rbegin(); symbolIt != symbols.rend(); symbolIt++){
+		stack.push(*symbolIt);
+	}
+	return stack;
+}
+
+namespace {
+
+// the stack operation of a transition on a std::stack or a PDAStack
+template <class Stack>
+void applyStackOperation(const PDAStackOperation& stackOperation, const char& topStack, const std::vector<char>& pushStack, Stack& in){
+	if(stackOperation == PUSH){
+		for(auto pushStackIt = pushStack.begin(); pushStackIt != pushStack.end();pushStackIt++){
 			in.push(*pushStackIt);
 		}
-	}else if(this->fStackOperation == POP){
+	}else if(stackOperation == POP){
 		if(in.size() == 0){
 			throw std::runtime_error("Try to pop something from an empty stack");
 			return;
 		}
 
-		if(in.top() == this->fTopStack){
-			if( this->fTopStack != 9){
+		if(in.top() == topStack){
+			if( topStack != 9){
 				in.pop();
 			}
 		}else{
 			throw std::runtime_error("Try to pop an element which is not at the top of the stack according to the transition info");
 		}
-	}else if(this->fStackOperation == POPPUSH){
+	}else if(stackOperation == POPPUSH){
 		if(in.size() == 0){
 			throw std::runtime_error("Try to pop something from an empty stack");
 			return;
 		}
 
-		if(in.top() == this->fTopStack){
-			if( this->fTopStack != 9){
+		if(in.top() == topStack){
+			if( topStack != 9){
 				in.pop();
 			}
-			for(auto pushStackIt = this->fPushStack.begin(); pushStackIt != this->fPushStack.end();pushStackIt++){
+			for(auto pushStackIt = pushStack.begin(); pushStackIt != pushStack.end();pushStackIt++){
 				in.push(*pushStackIt);
 			}
 		}else{
 			throw std::runtime_error("Try to pop an element which is not at the top of the stack according to the transition info");
 		}
-	}else if(this->fStackOperation == STAY){
+	}else if(stackOperation == STAY){
 		// do nothing
-	}else if(this->fStackOperation == EMPTY){
+	}else if(stackOperation == EMPTY){
 		if(in.size() == 0){
 			//throw std::runtime_error("Try to pop something from an empty stack");
 			return;
@@ -134,6 +200,16 @@ void PDATransition::stackOperation(std::stack<char>& in){
 	}
 }
 
+} // end namespace
+
+void PDATransition::stackOperation(std::stack<char>& in){
+	applyStackOperation(this->fStackOperation, this->fTopStack, this->fPushStack, in);
+}
+
+void PDATransition::stackOperation(PDAStack& in){
+	applyStackOperation(this->fStackOperation, this->fTopStack, this->fPushStack, in);
+}
+
 bool PDATransition::operator==(const PDATransition& other){
 	if(other.fFrom == this->fFrom and other.fTo == this->fTo and other.fInputSymbol == this->fInputSymbol and other.fPushStack == this->fPushStack and other.fTopStack == this->fTopStack){
 		return true;
@@ -180,21 +256,21 @@ PDATransition::~PDATransition() {
     // TODO Auto-generated destructor stub
 }
 
-PDAID::PDAID(const std::string& input, PDAState* currentState, const std::stack<char> stack){
-	this->fInput = input;
+PDAID::PDAID(const std::string& input, const std::size_t& position, PDAState* currentState, const PDAStack& stack) : fStack(stack){
+	this->fInput = &input;
+	this->fPosition = position;
 	this->fState = currentState;
-	this->fStack = stack;
 }
 
-void PDAID::step(const std::string& input, PDAState* to, const std::stack<char> stack){
-	this->fInput = input;
+void PDAID::step(const std::size_t& position, PDAState* to, const PDAStack& stack){
+	this->fPosition = position;
 	this->fState = to;
 	this->fStack = stack;
 }
 
 bool PDAID::isAccepted(PDAFinal pdaType){
 	bool accepted = false;
-	if(this->fInput.size() == 0){
+	if(this->fPosition == this->fInput->size()){
 		if(pdaType == STATE and this->fState->isFinal()){
 			// PDA is state ending
 			accepted = true;
@@ -212,9 +288,9 @@ bool PDAID::isAccepted(PDAFinal pdaType){
 
 
 std::ostream& operator<<(std::ostream& out, PDAID id){
-	std::stack<char> temp = id.fStack;
+	PDAStack temp = id.fStack;
 
-	out << "PDA ID(" << id.fInput << ", " << id.fState->getName() << ", ";
+	out << "PDA ID(" << id.getInput() << ", " << id.fState->getName() << ", ";
 	if(temp.size() != 0){
 		for(unsigned int i = 0; i <= temp.size(); i++){
 			if(temp.top() == 9){
@@ -243,10 +319,10 @@ PDA::PDA(const std::set<char>& alphabetPDA, const std::set<char>& alphabetStack,
 	this->fStack.push(9);
 }
 
-PDA::PDA(CFG cfg){
-	std::set<char> terminals = cfg.getTerminals();
-	std::set<char> variables = cfg.getVariables();
-	std::multimap<char, SymbolString> productions = cfg.getProductions();
+PDA::PDA(const CFG& cfg){
+	const std::set<char>& terminals = cfg.getTerminals();
+	const std::set<char>& variables = cfg.getVariables();
+	const std::multimap<char, SymbolString>& productions = cfg.getProductions();
 	char startSymbol = cfg.getStartsymbol();
 
 	// First add a state q;
@@ -727,6 +803,7 @@ bool PDA::addTransition(PDATransition transition){
 	if(std::find(this->fTransitions.begin(), this->fTransitions.end(), transition) == this->fTransitions.end()){
 		// Transition is not yet in fTransitions list
 		this->fTransitions.push_back(transition);
+		this->fIndexedBy = nullptr;
 		return true;
 	}else{
 		throw std::runtime_error("Transition is already in PDA");
@@ -734,88 +811,272 @@ bool PDA::addTransition(PDATransition transition){
 	}
 }
 
-std::vector<PDATransition> PDA::getTransitions(std::string input, char stackTopSymbol, PDAState* from){
-	std::vector<PDATransition> selectedTransitions;
+namespace {
 
+// the key of the transitions from the state with the id, with the input
+// symbol and stack top
+unsigned long long transitionKey(const unsigned int& from, const char& inputSymbol, const char& stackTopSymbol) {
+	return (static_cast<unsigned long long>(from) << 16)
+		| (static_cast<unsigned long long>(static_cast<unsigned char>(inputSymbol)) << 8)
+		| static_cast<unsigned char>(stackTopSymbol);
+}
 
-	for(auto transitionIt = fTransitions.begin(); transitionIt != fTransitions.end();transitionIt++){
-		if(input.size() != 0){
-			// only if there are characters, take the first character
-			if(transitionIt->getInputSymbol() == input.at(0)){
-				// This transition corresponds to the symbol from input we're reading now
-				if(transitionIt->getFrom() == from){
-					// This transition has the same from as given in the parameter list
-					if(transitionIt->getTopStack() == stackTopSymbol){
-						// Top of the PDA stack is equal to what the top of the stack should be in this transition
-						selectedTransitions.push_back(*transitionIt);
-					}
-				}
-			}
-		}
+// an ID as its state, input position and top stack cell
+struct PDAConfiguration {
+	explicit PDAConfiguration(PDAID& id){
+		this->state = id.getState();
+		this->position = id.getPosition();
+		this->stack = id.getStack().cell();
+	}
 
-		// Now add the epsilon transitions
-		if(transitionIt->getInputSymbol() == 0){
-			if(transitionIt->getTopStack() == stackTopSymbol and transitionIt->getFrom() == from){
-				selectedTransitions.push_back(*transitionIt);
-			}
-		}
+	bool operator==(const PDAConfiguration& other) const{
+		return this->state == other.state and this->position == other.position and this->stack == other.stack;
+	}
 
-		// Now add the empty transitions
-		if(transitionIt->getInputSymbol() == 5 and input.size() == 0){
-			if(transitionIt->getTopStack() == stackTopSymbol and transitionIt->getFrom() == from){
-				selectedTransitions.push_back(*transitionIt);
-			}
+	const PDAState* state;
+	std::size_t position;
+	int stack;
+};
+
+struct PDAConfigurationHash {
+	std::size_t operator()(const PDAConfiguration& configuration) const{
+		std::size_t hash = std::hash<const PDAState*>()(configuration.state);
+		hash = hash * 31 + configuration.position;
+		hash = hash * 31 + static_cast<std::size_t>(configuration.stack);
+		return hash;
+	}
+};
+
+// the symbols a transition puts in the place of the stack top it reads,
+// from the bottom up: Z0 is never popped, so a transition that pops it puts
+// it back
+std::vector<char> replacement(PDATransition& transition){
+	const char top = transition.getTopStack();
+	const std::vector<char> pushStack = transition.getPushStack();
+	std::vector<char> symbols;
+
+	if(transition.getStackOperation() == PUSH){
+		symbols.push_back(top);
+		symbols.insert(symbols.end(), pushStack.begin(), pushStack.end());
+	}else if(transition.getStackOperation() == POP){
+		if(top == 9){
+			symbols.push_back(top);
 		}
+	}else if(transition.getStackOperation() == POPPUSH){
+		if(top == 9){
+			symbols.push_back(top);
+		}
+		symbols.insert(symbols.end(), pushStack.begin(), pushStack.end());
+	}else if(transition.getStackOperation() == STAY){
+		symbols.push_back(top);
+	}else if(transition.getStackOperation() == EMPTY){
+		// the stack is never emptied, Z0 is pushed on top of it
+		symbols.push_back(top);
+		symbols.push_back(9);
 	}
 
-	return selectedTransitions;
+	return symbols;
+}
+
+// a stack top in a state at an input position, the state being nullptr for
+// the start state before it took a transition
+struct PDACall {
+	bool operator==(const PDACall& other) const{
+		return this->state == other.state and this->position == other.position and this->top == other.top;
+	}
+
+	PDAState* state;
+	std::size_t position;
+	char top;
+};
+
+struct PDACallHash {
+	std::size_t operator()(const PDACall& call) const{
+		std::size_t hash = std::hash<const PDAState*>()(call.state);
+		hash = hash * 31 + call.position;
+		hash = hash * 31 + static_cast<unsigned char>(call.top);
+		return hash;
+	}
+};
+
+// being in a state at an input position, with the first symbols (left) of
+// a replacement still to pop before the stack top of a call is popped (the
+// call is -1 for the stack the PDA starts with)
+struct PDAItem {
+	bool operator==(const PDAItem& other) const{
+		return this->call == other.call and this->replacement == other.replacement and this->left == other.left
+			and this->state == other.state and this->position == other.position;
+	}
+
+	int call;
+	const std::vector<char>* replacement;
+	std::size_t left;
+	PDAState* state;
+	std::size_t position;
+};
+
+struct PDAItemHash {
+	std::size_t operator()(const PDAItem& item) const{
+		std::size_t hash = static_cast<std::size_t>(item.call);
+		hash = hash * 31 + std::hash<const std::vector<char>*>()(item.replacement);
+		hash = hash * 31 + item.left;
+		hash = hash * 31 + std::hash<const PDAState*>()(item.state);
+		hash = hash * 31 + item.position;
+		return hash;
+	}
+};
+
+// what is known about a call: the states and positions after popping its
+// stack top, the items waiting for that, and whether the stack top is the
+// only symbol on the stack
+struct PDACallNode {
+	PDACall call;
+	std::vector< std::pair<PDAState*, std::size_t> > popped;
+	std::vector<PDAItem> waiting;
+
+	bool bottom;
+	std::vector<int> above; // the calls right on top of it, in its place
+};
+
+} // end namespace
+
+void PDA::buildIndex(){
+	// the states get an id in the order they are met, the pointers of the
+	// transitions are compared just as before
+	this->fStateIds.clear();
+	this->fBuckets.clear();
+	this->fIndex.clear();
+
+	std::vector<unsigned long long> keys;
+	for(auto transitionIt = this->fTransitions.begin(); transitionIt != this->fTransitions.end(); transitionIt++){
+		auto id = this->fStateIds.insert(std::make_pair(transitionIt->getFrom(), this->fStateIds.size())).first;
+		keys.push_back(transitionKey(id->second, transitionIt->getInputSymbol(), transitionIt->getTopStack()));
+	}
+
+	// count the transitions of each key, then give each one its range
+	for(auto keyIt = keys.begin(); keyIt != keys.end(); keyIt++){
+		this->fBuckets[*keyIt].second++;
+	}
+
+	std::size_t offset = 0;
+	for(auto bucketIt = this->fBuckets.begin(); bucketIt != this->fBuckets.end(); bucketIt++){
+		bucketIt->second.first = offset;
+		offset += bucketIt->second.second;
+		bucketIt->second.second = bucketIt->second.first;
+	}
+
+	// fill the ranges, keeping the order in which the transitions were added
+	this->fIndex.resize(keys.size());
+	std::size_t k = 0;
+	for(auto transitionIt = this->fTransitions.begin(); transitionIt != this->fTransitions.end(); transitionIt++, k++){
+		std::pair<std::size_t, std::size_t>& bucket = this->fBuckets[keys[k]];
+		this->fIndex[bucket.second++] = &(*transitionIt);
+	}
+
+	this->fIndexedBy = this;
+}
+
+PDATransitionSpan PDA::getTransitions(PDAState* from, const char& inputSymbol, const char& stackTopSymbol){
+	if(this->fIndexedBy != this){
+		this->buildIndex();
+	}
+
+	auto id = this->fStateIds.find(from);
+	if(id == this->fStateIds.end()){
+		return PDATransitionSpan();
+	}
+
+	auto bucket = this->fBuckets.find(transitionKey(id->second, inputSymbol, stackTopSymbol));
+	if(bucket == this->fBuckets.end()){
+		return PDATransitionSpan();
+	}
+
+	PDATransition* const* data = this->fIndex.data();
+	return PDATransitionSpan(data + bucket->second.first, data + bucket->second.second);
 }
 
 bool PDA::process(std::string input){
+	return this->process(input, PDA_SATURATION);
+}
+
+void PDA::checkInput(const std::string& input){
 	for(auto i : input) {
 		if(std::find(this->fAlphabet.begin(), this->fAlphabet.end(), i) == this->fAlphabet.end()){
 			throw std::runtime_error("There is a symbol in the input string which is not in the PDA's alphabet");
-			return false;
 		}
 	}
 
 	if(this->fStartState == nullptr){
 		throw std::runtime_error("Please define a  start state before processing a string");
-		return false;
 	}
+}
+
+bool PDA::process(std::string input, const PDAEngine& engine){
+	if(engine == PDA_SATURATION){
+		this->checkInput(input);
+		return this->saturate(input);
+	}
+
+	PDAStats stats;
+	return this->process(input, stats);
+}
+
+bool PDA::process(std::string input, PDAStats& stats){
+	stats = PDAStats();
+	this->checkInput(input);
 	std::queue<PDAID> ids;
 
-	// the first thing we do is adding all the ID's we get with the first input symbol from the start state
-	std::vector<PDATransition> selectedTransitions = this->getTransitions(input, this->fStack.top(), this->fStartState);
-	//std::cout << "Selected Transitions size " << selectedTransitions.size() << std::endl;
+	// the stacks of all ID's are made of the cells of this arena, so an ID
+	// shares the stack of the ID it came from below what it changed
+	PDAStackArena arena;
+	const PDAStack startStack(arena, this->fStack);
+
+	// the ID's made so far, an ID that was already made won't find anything new
+	std::unordered_set<PDAConfiguration, PDAConfigurationHash> seen;
+
+	// the first thing we do is adding all the ID's we get with the first input symbol from the start state:
+	// the transitions reading it (or the end of input ones if there is no input) and the epsilon transitions
+	const PDATransitionSpan startTransitions[2] = {
+		this->getTransitions(this->fStartState, input.size() != 0 ? input.at(0) : 5, this->fStack.top()),
+		this->getTransitions(this->fStartState, 0, this->fStack.top())
+	};
+
 	// add the initial ID's
-	for(auto transitionsIt = selectedTransitions.begin();transitionsIt != selectedTransitions.end();transitionsIt++){
-		// Determine the remaining input for the new id
-		std::string newInput = input;
-		if(transitionsIt->getInputSymbol() != 0){
-			// If the input symbol is not zero we need to remove a character from the input string
-			newInput.erase(0, 1);
-		}
+	for(const PDATransitionSpan& span : startTransitions){
+		for(PDATransition* transition : span){
+			// Determine the remaining input for the new id
+			std::size_t newPosition = 0;
+			if(transition->getInputSymbol() != 0 and input.size() != 0){
+				// If the input symbol is not zero we need to move past a character of the input string
+				newPosition = 1;
+			}
 
-		// Determine the remaining stack for the new id
-		std::stack<char> tempStack = this->fStack;
-		transitionsIt->stackOperation(tempStack);
+			// Determine the remaining stack for the new id
+			PDAStack tempStack = startStack;
+			transition->stackOperation(tempStack);
 
-		// Make id
-		PDAID newID(newInput, transitionsIt->getTo(), tempStack);
+			// Make id
+			PDAID newID(input, newPosition, transition->getTo(), tempStack);
+			stats.ids++;
 
-		// If the id is already accepted we can stop here
-		if(newID.isAccepted(this->fPDAtype) == true){
-			//std::cout << "Final in first stage with " << newID << std::endl;
-			return true;
-		}
+			// If the id is already accepted we can stop here
+			if(newID.isAccepted(this->fPDAtype) == true){
+				stats.cells = arena.size();
+				return true;
+			}
 
-		ids.push(newID);
+			if(seen.insert(PDAConfiguration(newID)).second == false){
+				stats.duplicates++;
+				continue;
+			}
+
+			ids.push(newID);
+		}
 	}
 
 
 	// If there are no transitions found starting from the start state but maybe the start state is already accepting
-	if(selectedTransitions.size() == 0){
+	if(startTransitions[0].empty() and startTransitions[1].empty()){
 		if(input.size() == 0){
 			if(this->fPDAtype == STACK){
 				// No states to go to anymore so it's final!
@@ -830,75 +1091,225 @@ bool PDA::process(std::string input){
 		}
 	}
 
-	// Clean the vector so we can use it elsewhere
-	selectedTransitions.clear();
-
-
-	//std::cout << "ids size " << ids.size() <<std::endl;
-
 
 	// That's done now start using these id's to find a succesfull path
 	while(ids.size() > 0){
 		// Now let's check if we are already accepted
 		if(ids.front().isAccepted(this->fPDAtype) == true){
 			// YES, we're final!
+			stats.cells = arena.size();
 			return true;
 		}
 
 		// get the transitions corresponding with the character and the top of the stack
-		selectedTransitions = this->getTransitions(ids.front().getInput(), ids.front().getStack().top(), ids.front().getState());
-		//std::cout << selectedTransitions.size() <<  "Transitions found for " << ids.front() <<std::endl;
-
-		if(selectedTransitions.size() == 0){
-			// there are no transition possible anymore so remove this ID
-			//std::cout << "Remove ID:" << ids.front() << std::endl;
-			ids.pop();
-		}else{
-			// there are multiple transitions possible so also multiple ID's
-
-			//std::cout << "Change ID:" << ids.front() << std::endl;
-
-			// Now we're gonna add new ID's for each transition
-			for(auto transitionsIt = selectedTransitions.begin();transitionsIt != selectedTransitions.end();transitionsIt++){
+		const std::size_t position = ids.front().getPosition();
+		const char stackTop = ids.front().getStack().top();
+		const PDATransitionSpan selectedTransitions[2] = {
+			this->getTransitions(ids.front().getState(), position != input.size() ? input[position] : 5, stackTop),
+			this->getTransitions(ids.front().getState(), 0, stackTop)
+		};
+
+		// Now we're gonna add new ID's for each transition, if there are none the ID is just removed
+		for(const PDATransitionSpan& span : selectedTransitions){
+			for(PDATransition* transition : span){
 				// Determine new input
-				std::string newInput = ids.front().getInput();
-				if(transitionsIt->getInputSymbol() != 0){
-					// If the input symbol is not zero we need to remove a character from the input string
-					newInput.erase(0, 1);
+				std::size_t newPosition = position;
+				if(transition->getInputSymbol() != 0 and position != input.size()){
+					// If the input symbol is not zero we need to move past a character of the input string
+					newPosition++;
 				}
 
 				// Determine new stack
-				std::stack<char> newStack(ids.front().getStack());
-				transitionsIt->stackOperation(newStack);
+				PDAStack newStack = ids.front().getStack();
+				transition->stackOperation(newStack);
 
 				// Make new ID
-				PDAID newID(newInput, transitionsIt->getTo(), newStack);
+				PDAID newID(input, newPosition, transition->getTo(), newStack);
+				stats.ids++;
 
 				// check whether we are accepted
 				if(newID.isAccepted(this->fPDAtype) == true){
 					// YES, we're final!
+					stats.cells = arena.size();
 					return true;
 				}
 
 				// We're not going to add endless id's when we're building based upon a cfg
-				if(this->fBasedUponCFG == true and newID.getStack().size() > newID.getInput().size() + 5){
+				if(this->fBasedUponCFG == true and newID.getStack().size() > newID.getRemaining() + 5){
+					stats.cut++;
+					continue;
+				}
+
+				// The same ID was already made, so its ID's are made as well
+				if(seen.insert(PDAConfiguration(newID)).second == false){
+					stats.duplicates++;
 					continue;
 				}
 
 				// Add the new ID
 				ids.push(newID);
-				//std::cout << "   for: " << newID << std::endl;
 			}
-
-			// Remove the current ID so we won't process it again
-			ids.pop();
 		}
 
-		// clean the vector for the next turn
-		selectedTransitions.clear();
+		// Remove the current ID so we won't process it again
+		ids.pop();
 	}
 
 	// No path ended in a final state or empty stack
+	stats.cells = arena.size();
+	return false;
+}
+
+bool PDA::saturate(const std::string& input){
+	// no transitions at all from the start state, just like the search
+	if(input.size() == 0
+		and this->getTransitions(this->fStartState, 5, this->fStack.top()).empty()
+		and this->getTransitions(this->fStartState, 0, this->fStack.top()).empty()){
+		return this->fPDAtype == STACK or this->fStartState->isFinal();
+	}
+
+	// the start stack from the bottom up
+	std::vector<char> start;
+	for(std::stack<char> temp = this->fStack; !temp.empty(); temp.pop()){
+		start.insert(start.begin(), temp.top());
+	}
+
+	std::vector<PDACallNode> calls;
+	std::unordered_map<PDACall, int, PDACallHash> callIds;
+	std::unordered_map<PDATransition*, std::vector<char> > replacements;
+
+	std::vector<PDAItem> todo;
+	std::unordered_set<PDAItem, PDAItemHash> seen;
+	std::unordered_set<PDAItem, PDAItemHash> popped;
+
+	auto add = [&](const PDAItem& item){
+		if(seen.insert(item).second == true){
+			todo.push_back(item);
+		}
+	};
+
+	// mark the call and the calls above it as the only symbol on the stack,
+	// true if that makes an ID accepted
+	auto markBottom = [&](const int& call){
+		std::vector<int> marking(1, call);
+		while(marking.size() > 0){
+			const int current = marking.back();
+			marking.pop_back();
+
+			if(calls[current].bottom == true){
+				continue;
+			}
+			calls[current].bottom = true;
+
+			const PDACall& id = calls[current].call;
+			if(this->fPDAtype == STACK and id.state != nullptr and id.position == input.size() and id.top == 9){
+				return true;
+			}
+
+			marking.insert(marking.end(), calls[current].above.begin(), calls[current].above.end());
+		}
+		return false;
+	};
+
+	PDAItem first = {-1, &start, start.size(), nullptr, 0};
+	add(first);
+
+	while(todo.size() > 0){
+		const PDAItem item = todo.back();
+		todo.pop_back();
+
+		if(item.left == 0){
+			if(item.call == -1){
+				// the stack is empty
+				if(item.state != nullptr and item.position == input.size() and (this->fPDAtype == STACK or item.state->isFinal())){
+					return true;
+				}
+				continue;
+			}
+
+			// the stack top of the call is popped, continue with the items waiting for that
+			PDAItem key = {item.call, nullptr, 0, item.state, item.position};
+			if(popped.insert(key).second == false){
+				continue;
+			}
+
+			calls[item.call].popped.push_back(std::make_pair(item.state, item.position));
+			const std::vector<PDAItem>& waiting = calls[item.call].waiting;
+			for(auto waitingIt = waiting.begin(); waitingIt != waiting.end(); waitingIt++){
+				PDAItem next = {waitingIt->call, waitingIt->replacement, waitingIt->left - 1, item.state, item.position};
+				add(next);
+			}
+			continue;
+		}
+
+		// the symbol on top of the stack, find out where it gets popped
+		PDACall call = {item.state, item.position, (*item.replacement)[item.left - 1]};
+		auto callId = callIds.find(call);
+		int current;
+
+		if(callId == callIds.end()){
+			current = calls.size();
+			callIds[call] = current;
+
+			PDACallNode node;
+			node.call = call;
+			node.bottom = false;
+			calls.push_back(node);
+
+			if(this->fPDAtype == STATE and call.state != nullptr and call.position == input.size() and call.state->isFinal()){
+				return true;
+			}
+
+			// the transitions reading the next input symbol (or the end of input ones) and the epsilon transitions
+			PDAState* from = call.state != nullptr ? call.state : this->fStartState;
+			const PDATransitionSpan spans[2] = {
+				this->getTransitions(from, call.position != input.size() ? input[call.position] : 5, call.top),
+				this->getTransitions(from, 0, call.top)
+			};
+
+			for(const PDATransitionSpan& span : spans){
+				for(PDATransition* transition : span){
+					std::size_t newPosition = call.position;
+					if(transition->getInputSymbol() != 0 and call.position != input.size()){
+						newPosition++;
+					}
+
+					auto symbols = replacements.find(transition);
+					if(symbols == replacements.end()){
+						symbols = replacements.insert(std::make_pair(transition, replacement(*transition))).first;
+					}
+
+					PDAItem next = {current, &symbols->second, symbols->second.size(), transition->getTo(), newPosition};
+					add(next);
+				}
+			}
+		}else{
+			current = callId->second;
+		}
+
+		// the last symbol left is in the place of the stack top of the item's call
+		if(item.left == 1){
+			if(item.call == -1){
+				if(markBottom(current) == true){
+					return true;
+				}
+			}else{
+				calls[item.call].above.push_back(current);
+				if(calls[item.call].bottom == true and markBottom(current) == true){
+					return true;
+				}
+			}
+		}
+
+		calls[current].waiting.push_back(item);
+		const std::vector< std::pair<PDAState*, std::size_t> >& done = calls[current].popped;
+		for(auto doneIt = done.begin(); doneIt != done.end(); doneIt++){
+			PDAItem next = {item.call, item.replacement, item.left - 1, doneIt->first, doneIt->second};
+			add(next);
+		}
+	}
+
+	// no ID ended in a final state or empty stack
 	return false;
 }
 
@@ -35,6 +35,8 @@
 #include <algorithm>
 #include <queue>
 #include <fstream>
+#include <cstddef>
+#include <unordered_map>
 #include "CFG.h"
 #include "TinyXML/tinyxml.h"
 
@@ -91,6 +93,106 @@ private:
         bool fFinal;
 };
 
+/**
+ * @brief The cells of persistent stacks: each cell is a symbol and the cell
+ * below it. Cells are never changed or removed, so all stacks pushed onto
+ * the same stack share it as their tail. There is only one cell for each
+ * symbol on top of a cell, so two stacks are equal if and only if they have
+ * the same top cell.
+ */
+class PDAStackArena {
+public:
+    /**
+     * @brief Get the cell with a symbol on top of another cell (-1 for the
+     * bottom of the stack), it is added if there is none yet.
+     *
+     * @return The index of the cell
+     */
+    int cons(const char& symbol, const int& below){
+        const unsigned long long key = (static_cast<unsigned long long>(below + 1) << 8) | static_cast<unsigned char>(symbol);
+        auto found = this->fIndex.find(key);
+        if(found != this->fIndex.end()){
+            return found->second;
+        }
+
+        Cell cell = {symbol, below};
+        this->fCells.push_back(cell);
+        this->fIndex[key] = this->fCells.size() - 1;
+        return this->fCells.size() - 1;
+    };
+
+    /**
+     * @brief get the symbol of a cell
+     */
+    char symbol(const int& cell) const{ return this->fCells[cell].symbol;};
+
+    /**
+     * @brief get the cell below a cell, -1 if it's the bottom one
+     */
+    int below(const int& cell) const{ return this->fCells[cell].below;};
+
+    /**
+     * @brief get the amount of cells
+     */
+    std::size_t size() const{ return this->fCells.size();};
+
+private:
+    struct Cell {
+        char symbol;
+        int below;
+    };
+
+    std::vector<Cell> fCells;
+    std::unordered_map<unsigned long long, int> fIndex;
+};
+
+/**
+ * @brief A stack with the same operations as std::stack<char>, but made of
+ * the cells of a PDAStackArena. A copy only copies the top cell and the
+ * size, pushing and popping only change the top cell, so copies share
+ * everything below and never change each other. It can only be used while
+ * the arena exists.
+ */
+class PDAStack {
+public:
+    /**
+     * @brief Constructor, an empty stack
+     *
+     * @param arena The arena the cells are added to
+     */
+    explicit PDAStack(PDAStackArena& arena);
+
+    /**
+     * @brief Constructor, a stack with the same symbols as a std::stack
+     *
+     * @param arena The arena the cells are added to
+     * @param stack The symbols
+     */
+    PDAStack(PDAStackArena& arena, const std::stack<char>& stack);
+
+    void push(const char& symbol);
+    void pop();
+    char top() const;
+    std::size_t size() const;
+    bool empty() const;
+
+    /**
+     * @brief get the top cell, stacks of the same arena are equal if and
+     * only if their top cells are (-1 for the empty stack)
+     */
+    int cell() const;
+
+    /**
+     * @brief get the symbols as a std::stack
+     */
+    std::stack<char> toStack() const;
+
+private:
+    PDAStackArena* fArena;
+    int fTop;
+    std::size_t fSize;
+};
+
 enum PDAStackOperation{
     PUSH,
     POP,
@@ -175,6 +277,13 @@ public:
 	 */
     void stackOperation(std::stack<char>& in);
 
+	/**
+	 * @brief Change a persistent stack based upon the data in the transition, just as above
+	 *
+	 * @param in A persistent stack, other copies of it don't change
+	 */
+    void stackOperation(PDAStack& in);
+
     /**
 	 * @brief << overloading
 	 */
@@ -244,35 +353,78 @@ private:
     PDAStackOperation fStackOperation;
 };
 
+/**
+ * @brief A range of transitions of a PDA, pointing into its transition index
+ * so nothing is copied. It becomes invalid as soon as a transition is added
+ * to the PDA.
+ */
+class PDATransitionSpan {
+public:
+    PDATransitionSpan() : fFirst(nullptr), fLast(nullptr) {}
+    PDATransitionSpan(PDATransition* const* first, PDATransition* const* last) : fFirst(first), fLast(last) {}
+
+    PDATransition* const* begin() const { return fFirst; }
+    PDATransition* const* end() const { return fLast; }
+
+    /**
+     * @brief Get the amount of transitions in the range.
+     */
+    std::size_t size() const { return fLast - fFirst; }
+
+    /**
+     * @brief Check whether there are no transitions in the range.
+     */
+    bool empty() const { return fFirst == fLast; }
+
+private:
+    PDATransition* const* fFirst;
+    PDATransition* const* fLast;
+};
+
 // Is the PDA final with empty stack or in final State
 enum PDAFinal{
     STACK,
     STATE
 };
 
+// How PDA::process decides whether a string is accepted
+enum PDAEngine{
+    PDA_SEARCH,    // breadth first search over the ID's
+    PDA_SATURATION // summaries of the stack symbols over parts of the input, at most cubic time
+};
+
 /**
- * @brief Class representing a PDA Instantenious Description
+ * @brief Class representing a PDA Instantenious Description, the remaining
+ * input is a position in the input string (which is shared by all ID's, so
+ * it should live as long as the ID)
  */
 class PDAID{
 public:
     /**
      * @brief Constructor
      *
-     * @param input The input string
+     * @param input The whole input string
+     * @param position The position of the first symbol of the remaining input
      * @param currentState The pointer to state where the ID starts
      * @param stack The stack at this moment
      */
 
-	PDAID(const std::string& input, PDAState* currentState, const std::stack<char> stack);
+	PDAID(const std::string& input, const std::size_t& position, PDAState* currentState, const PDAStack& stack);
+
+    /**
+     * @brief The ID keeps a pointer to the input string, so it can't be a
+     * temporary one
+     */
+	PDAID(std::string&& input, const std::size_t& position, PDAState* currentState, const PDAStack& stack) = delete;
 
     /**
      * @brief Process the ID according to one transition for one step
      *
+     * @param position The position of the remaining input after the transition
      * @param to Pointer to next state
-     * @param inputSymbol Character accompanied with this transition
-     * @param topStack Character that should be at the top of the stack after the transition
+     * @param stack The stack after the transition
      */
-    void step(const std::string& input, PDAState* currentState, const std::stack<char> stack);
+    void step(const std::size_t& position, PDAState* currentState, const PDAStack& stack);
 
     /**
 	 * @brief Check if this ID will be accepted by the PDA
@@ -289,11 +441,25 @@ public:
     friend std::ostream& operator<<(std::ostream& out, PDAID id);
 
     /**
-     * @brief get the input of the ID
+     * @brief get the remaining input of the ID, a copy of it
      *
      * @return string
      */
-    std::string getInput(){ return this->fInput;};
+    std::string getInput(){ return this->fInput->substr(this->fPosition);};
+
+    /**
+     * @brief get the position of the remaining input in the input string
+     *
+     * @return position
+     */
+    std::size_t getPosition() const{ return this->fPosition;};
+
+    /**
+     * @brief get the amount of symbols of the remaining input
+     *
+     * @return size
+     */
+    std::size_t getRemaining() const{ return this->fInput->size() - this->fPosition;};
 
     /**
 	 * @brief get the state of the ID
@@ -305,14 +471,34 @@ public:
     /**
 	 * @brief get the stack of the ID
 	 *
-	 * @return stack with chars
+	 * @return persistent stack with chars, copying it copies nothing of the stack itself
 	 */
-    std::stack<char> getStack(){ return this->fStack;};
+    const PDAStack& getStack() const{ return this->fStack;};
 
 private:
-    std::string fInput;
+    const std::string* fInput;
+    std::size_t fPosition;
     PDAState* fState;
-    std::stack<char> fStack;
+    PDAStack fStack;
+};
+
+/**
+ * @brief The amount of work done by PDA::process
+ */
+struct PDAStats {
+    // the ID's made by following a transition
+    std::size_t ids = 0;
+
+    // the ones thrown away because an ID with the same state, input position
+    // and stack was already made
+    std::size_t duplicates = 0;
+
+    // the ones thrown away because the stack is too big (for a PDA based
+    // upon a CFG)
+    std::size_t cut = 0;
+
+    // the cells of all stacks together
+    std::size_t cells = 0;
 };
 
 /**
@@ -339,7 +525,7 @@ public:
     *
     * @param cfg A Context Free Grammar to be transformed to a PDA
     */
-    PDA(CFG cfg);
+    PDA(const CFG& cfg);
 
     /**
      * @brief Constructor
@@ -377,7 +563,8 @@ public:
     bool addTransition(PDATransition transition);
 
     /**
-     * @brief Process an input string through the PDA
+     * @brief Process an input string through the PDA, with the PDA_SATURATION
+     * engine
      *
      * @param input The string to be processed by the PDA
      *
@@ -385,6 +572,38 @@ public:
      */
     bool process(std::string input);
 
+    /**
+     * @brief Process an input string through the PDA, and count the work
+     * it takes. An ID that is the same (state, input position and stack) as
+     * one seen before is not processed again.
+     *
+     * @param input The string to be processed by the PDA
+     * @param stats The counts, they are set by this function
+     *
+     * @return A bool telling if the PDA ended in a final state or empty stack
+     */
+    bool process(std::string input, PDAStats& stats);
+
+    /**
+     * @brief Process an input string through the PDA with the chosen engine
+     *
+     * PDA_SEARCH is the breadth first search over the ID's of
+     * process(input, stats), a PDA based upon a CFG throws away ID's with
+     * more stack symbols than there is input left (plus 5) to end.
+     *
+     * PDA_SATURATION computes for each state, input position and stack top
+     * (p, i, A) the states and positions (q, j) where the PDA can be after
+     * popping that A, reading the input from i up to j (the construction of
+     * a CFG from a PDA). There are at most cubically many of these in the
+     * length of the input, so it ends without throwing away anything.
+     *
+     * @param input The string to be processed by the PDA
+     * @param engine The engine
+     *
+     * @return A bool telling if the PDA ended in a final state or empty stack
+     */
+    bool process(std::string input, const PDAEngine& engine);
+
     /**
      * @brief Store an PDA in a dot file
      *
@@ -403,15 +622,35 @@ public:
 
 private:
     /**
-     * @brief Get transitions based upon an input, stackTopsymbol and state
+     * @brief Get the transitions from a state with an input symbol and a
+     * symbol on the top of the stack, in the order they were added. The
+     * epsilon transitions (input 0) and the transitions at the end of the
+     * input (input 5) have their own input symbol, so each one is a
+     * separate lookup.
      *
-     * @param input Which string should be processed by the state
-     * @param stackTopSymbol The symbol on the top of the stack at the moment this function is called
      * @param from A PDAState from where the transitions should start
+     * @param inputSymbol The input symbol of the transitions
+     * @param stackTopSymbol The symbol on the top of the stack
      *
-     * @return A vector<PDATransition> giving you all the transitions starting from the specified state
+     * @return The transitions, valid until a transition is added
      */
-    std::vector<PDATransition> getTransitions(std::string input, char stackTopSymbol, PDAState* from);
+    PDATransitionSpan getTransitions(PDAState* from, const char& inputSymbol, const char& stackTopSymbol);
+
+    /**
+     * @brief Group the transitions on (from, input symbol, stack top), this
+     * is done once before processing, after the last transition was added.
+     */
+    void buildIndex();
+
+    /**
+     * @brief Throw if the PDA can't process the input string
+     */
+    void checkInput(const std::string& input);
+
+    /**
+     * @brief The PDA_SATURATION engine of process(), after checking the input
+     */
+    bool saturate(const std::string& input);
 
 
     std::list<PDATransition> fTransitions;
@@ -427,6 +666,16 @@ private:
     std::stack<char> fStack;
 
     bool fBasedUponCFG = false; // So we do not spend computer time at running in loops
+
+    // the transitions grouped on (from, input symbol, stack top), each group
+    // being a range of fIndex
+    std::vector<PDATransition*> fIndex;
+    std::unordered_map<unsigned long long, std::pair<std::size_t, std::size_t> > fBuckets;
+    std::unordered_map<const PDAState*, unsigned int> fStateIds;
+
+    // the PDA that built the index, nullptr if it has to be (re)built: a copy
+    // has to build its own, pointing into its own list of transitions
+    const PDA* fIndexedBy = nullptr;
 };
 
 
@@ -0,0 +1,297 @@
+/* RecognizerGenerator
+ * Implementation of the generation of specialized recognizers.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RecognizerGenerator.h"
+#include "CYK.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <tuple>
+#include <utility>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// a terminal as C++ character literal
+std::string character(const char& t) {
+    if (std::isprint(static_cast<unsigned char>(t)) && t != '\'' && t != '\\')
+        return std::string("'") + t + "'";
+
+    std::ostringstream out;
+    out << "static_cast<char>(" << static_cast<int>(static_cast<unsigned char>(t)) << ")";
+    return out.str();
+}
+
+bool isIdentifier(const std::string& name) {
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])))
+        return false;
+
+    for (const char& c : name) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_')
+            return false;
+    } // end for
+
+    return true;
+}
+
+} // end namespace
+
+void generateRecognizer(const CNF& cnf, const std::string& name, std::ostream& out, const std::string& source) {
+    if (!isIdentifier(name))
+        throw std::invalid_argument("The name of a recognizer must be an identifier.");
+
+    const CYKGrammar grammar(cnf);
+
+    std::string guard = "H_";
+    for (const char& c : name) {
+        guard += std::toupper(static_cast<unsigned char>(c));
+    } // end for
+    guard += "_RECOGNIZER_H";
+
+    const std::set<char>& terminals = cnf.getTerminals();
+
+    // the binary rules sorted on the body, such that the rules of each pair
+    // (B, C) are next to each other
+    std::vector<CYKGrammar::BinaryRule> rules = grammar.binaryRules();
+    std::sort(rules.begin(), rules.end(), [](const CYKGrammar::BinaryRule& x, const CYKGrammar::BinaryRule& y) {
+        return std::make_tuple(x.left, x.right, x.head) < std::make_tuple(y.left, y.right, y.head);
+    });
+
+    // the terminal rules, sorted on the terminal
+    std::vector< std::pair<char, unsigned int> > terminalRules;
+    for (const char& t : terminals) {
+        const CYKWord* word = grammar.terminal(t);
+
+        for (unsigned int id = 0; id < grammar.size(); ++id) {
+            if ((word[id / 64] >> (id % 64) & 1) != 0)
+                terminalRules.push_back(std::make_pair(t, id));
+        } // end for
+    } // end for
+
+    out << "/* " << name << "Recognizer" << std::endl;
+    out << " * Generated from " << (source.empty() ? "a CNF" : source) << " by GenerateRecognizer, don't edit." << std::endl;
+    out << " */" << std::endl << std::endl;
+    out << "#ifndef " << guard << std::endl;
+    out << "#define " << guard << std::endl << std::endl;
+    out << "#include <cstddef>" << std::endl;
+    out << "#include <cstdint>" << std::endl;
+    out << "#include <stdexcept>" << std::endl;
+    out << "#include <string>" << std::endl;
+    out << "#include <vector>" << std::endl << std::endl;
+    out << "namespace " << name << " {" << std::endl << std::endl;
+
+    // the tables
+    out << "struct BinaryRule {" << std::endl;
+    out << "    unsigned int head;" << std::endl;
+    out << "    unsigned int left;" << std::endl;
+    out << "    unsigned int right;" << std::endl;
+    out << "};" << std::endl << std::endl;
+    out << "struct TerminalRule {" << std::endl;
+    out << "    unsigned int head;" << std::endl;
+    out << "    char terminal;" << std::endl;
+    out << "};" << std::endl << std::endl;
+
+    out << "constexpr unsigned int VARIABLES = " << grammar.size() << ";" << std::endl;
+    out << "constexpr std::size_t WORDS = " << (grammar.size() == 0 ? 1 : (grammar.size() + 63) / 64) << ";" << std::endl;
+    out << "constexpr bool HAS_START = " << (grammar.hasStart() ? "true" : "false") << ";" << std::endl;
+    out << "constexpr unsigned int START = " << (grammar.hasStart() ? grammar.start() : 0) << ";" << std::endl << std::endl;
+
+    out << "constexpr char TERMINALS[] = {";
+    for (const char& t : terminals) {
+        out << character(t) << ", ";
+    } // end for
+    out << "0};" << std::endl;
+    out << "constexpr std::size_t TERMINAL_COUNT = " << terminals.size() << ";" << std::endl << std::endl;
+
+    // an array can't be empty, but the counts can be 0
+    out << "// sorted on the terminal" << std::endl;
+    out << "constexpr TerminalRule TERMINAL_RULES[] = {" << std::endl;
+    for (const std::pair<char, unsigned int>& r : terminalRules) {
+        out << "    {" << r.second << ", " << character(r.first) << "}," << std::endl;
+    } // end for
+    if (terminalRules.empty())
+        out << "    {0, 0}" << std::endl;
+    out << "};" << std::endl;
+    out << "constexpr std::size_t TERMINAL_RULE_COUNT = " << terminalRules.size() << ";" << std::endl << std::endl;
+
+    out << "// sorted on the body" << std::endl;
+    out << "constexpr BinaryRule BINARY_RULES[] = {" << std::endl;
+    for (const CYKGrammar::BinaryRule& r : rules) {
+        out << "    {" << r.head << ", " << r.left << ", " << r.right << "}," << std::endl;
+    } // end for
+    if (rules.empty())
+        out << "    {0, 0, 0}" << std::endl;
+    out << "};" << std::endl;
+    out << "constexpr std::size_t BINARY_RULE_COUNT = " << rules.size() << ";" << std::endl << std::endl;
+
+    // the checks of the unrolled code against the tables
+    out << "// whether the terminal rules from first up to last are all for t" << std::endl;
+    out << "constexpr bool forTerminal(const std::size_t& first, const std::size_t& last, const char& t) {" << std::endl;
+    out << "    return first == last || (TERMINAL_RULES[first].terminal == t && forTerminal(first + 1, last, t));" << std::endl;
+    out << "}" << std::endl << std::endl;
+    out << "// whether the binary rules from first up to last all have the body of first" << std::endl;
+    out << "constexpr bool sameBody(const std::size_t& first, const std::size_t& last) {" << std::endl;
+    out << "    return last - first < 2 || (BINARY_RULES[first].left == BINARY_RULES[first + 1].left" << std::endl;
+    out << "        && BINARY_RULES[first].right == BINARY_RULES[first + 1].right && sameBody(first + 1, last));" << std::endl;
+    out << "}" << std::endl << std::endl;
+
+    // a set of variables
+    out << "// a set of variables as bitset" << std::endl;
+    out << "struct Variables {" << std::endl;
+    out << "    std::uint64_t words[WORDS];" << std::endl << std::endl;
+    out << "    void add(const unsigned int& a) {" << std::endl;
+    out << "        words[a / 64] |= std::uint64_t(1) << (a % 64);" << std::endl;
+    out << "    }" << std::endl << std::endl;
+    out << "    bool has(const unsigned int& a) const {" << std::endl;
+    out << "        return (words[a / 64] >> (a % 64) & 1) != 0;" << std::endl;
+    out << "    }" << std::endl;
+    out << "};" << std::endl << std::endl;
+
+    // the set of variables for each terminal, a case for each run of
+    // TERMINAL_RULES
+    out << "// the variables A with A --> t, none if t isn't a terminal" << std::endl;
+    out << "inline Variables terminal(const char& t) {" << std::endl;
+    out << "    Variables result = {};" << std::endl << std::endl;
+    out << "    switch (t) {" << std::endl;
+    for (std::size_t first = 0; first < terminalRules.size();) {
+        std::size_t last = first;
+        while (last < terminalRules.size() && terminalRules[last].first == terminalRules[first].first) {
+            ++last;
+        } // end while
+
+        const std::string t = character(terminalRules[first].first);
+        out << "    case " << t << ":" << std::endl;
+        out << "        static_assert(forTerminal(" << first << ", " << last << ", " << t
+            << "), \"The cases don't match TERMINAL_RULES.\");" << std::endl;
+        for (std::size_t r = first; r < last; ++r) {
+            out << "        result.add(TERMINAL_RULES[" << r << "].head);" << std::endl;
+        } // end for
+        out << "        break;" << std::endl;
+
+        first = last;
+    } // end for
+    out << "    default:" << std::endl;
+    out << "        break;" << std::endl;
+    out << "    } // end switch" << std::endl << std::endl;
+    out << "    return result;" << std::endl;
+    out << "}" << std::endl << std::endl;
+
+    // the matrices, as in CYKMatrix
+    out << "// for each variable A and position i the ends j with A deriving the" << std::endl;
+    out << "// substring from i up to j (the rows), and for each variable and end j the" << std::endl;
+    out << "// starts i (the columns), as bitsets over the positions" << std::endl;
+    out << "class Table {" << std::endl;
+    out << "public:" << std::endl;
+    out << "    explicit Table(const std::size_t& n)" << std::endl;
+    out << "        : fLength(n), fWords(n / 64 + 1)," << std::endl;
+    out << "        fRows(VARIABLES * (n + 1) * fWords, 0), fColumns(VARIABLES * (n + 1) * fWords, 0) {" << std::endl;
+    out << "    }" << std::endl << std::endl;
+    out << "    void add(const unsigned int& a, const std::size_t& i, const std::size_t& j) {" << std::endl;
+    out << "        fRows[(a * (fLength + 1) + i) * fWords + j / 64] |= std::uint64_t(1) << (j % 64);" << std::endl;
+    out << "        fColumns[(a * (fLength + 1) + j) * fWords + i / 64] |= std::uint64_t(1) << (i % 64);" << std::endl;
+    out << "    }" << std::endl << std::endl;
+    out << "    bool has(const unsigned int& a, const std::size_t& i, const std::size_t& j) const {" << std::endl;
+    out << "        return (fRows[(a * (fLength + 1) + i) * fWords + j / 64] >> (j % 64) & 1) != 0;" << std::endl;
+    out << "    }" << std::endl << std::endl;
+    out << "    // whether B derives the substring from i up to k and C the one from k" << std::endl;
+    out << "    // up to j for some i < k < j" << std::endl;
+    out << "    bool meets(const unsigned int& b, const unsigned int& c, const std::size_t& i, const std::size_t& j) const {" << std::endl;
+    out << "        const std::uint64_t* row = &fRows[(b * (fLength + 1) + i) * fWords];" << std::endl;
+    out << "        const std::uint64_t* column = &fColumns[(c * (fLength + 1) + j) * fWords];" << std::endl << std::endl;
+    out << "        for (std::size_t w = (i + 1) / 64; w <= (j - 1) / 64; ++w) {" << std::endl;
+    out << "            if ((row[w] & column[w]) != 0)" << std::endl;
+    out << "                return true;" << std::endl;
+    out << "        } // end for" << std::endl << std::endl;
+    out << "        return false;" << std::endl;
+    out << "    }" << std::endl << std::endl;
+    out << "private:" << std::endl;
+    out << "    std::size_t fLength;" << std::endl;
+    out << "    std::size_t fWords;" << std::endl;
+    out << "    std::vector<std::uint64_t> fRows;" << std::endl;
+    out << "    std::vector<std::uint64_t> fColumns;" << std::endl;
+    out << "};" << std::endl << std::endl;
+
+    // a check for each run of BINARY_RULES with the same body
+    out << "// the variables A with A --> BC, B deriving the substring from i up to k" << std::endl;
+    out << "// and C the one from k up to j, with one check for each pair (B, C)" << std::endl;
+    out << "inline Variables combine(const Table& table, const std::size_t& i, const std::size_t& j) {" << std::endl;
+    out << "    Variables result = {};" << std::endl;
+    for (std::size_t first = 0; first < rules.size();) {
+        std::size_t last = first;
+        while (last < rules.size() && rules[last].left == rules[first].left && rules[last].right == rules[first].right) {
+            ++last;
+        } // end while
+
+        out << std::endl;
+        out << "    static_assert(sameBody(" << first << ", " << last
+            << "), \"The checks don't match BINARY_RULES.\");" << std::endl;
+
+        // no need to look for heads that are already there
+        out << "    if (!(";
+        for (std::size_t r = first; r < last; ++r) {
+            out << (r == first ? "" : " && ") << "result.has(BINARY_RULES[" << r << "].head)";
+        } // end for
+        out << ")" << std::endl;
+        out << "        && table.meets(BINARY_RULES[" << first << "].left, BINARY_RULES[" << first << "].right, i, j)) {" << std::endl;
+        for (std::size_t r = first; r < last; ++r) {
+            out << "        result.add(BINARY_RULES[" << r << "].head);" << std::endl;
+        } // end for
+        out << "    } // end if" << std::endl;
+
+        first = last;
+    } // end for
+    out << std::endl;
+    out << "    return result;" << std::endl;
+    out << "}" << std::endl << std::endl;
+
+    // the CYK algorithm
+    out << "// the CYK algorithm on the table, one length after the other" << std::endl;
+    out << "inline bool recognize(const std::string& str) {" << std::endl;
+    out << "    const std::size_t n = str.size();" << std::endl;
+    out << "    Table table(n);" << std::endl << std::endl;
+    out << "    for (std::size_t i = 0; i < n; ++i) {" << std::endl;
+    out << "        bool valid = false;" << std::endl;
+    out << "        for (std::size_t k = 0; k < TERMINAL_COUNT; ++k) {" << std::endl;
+    out << "            valid = valid || TERMINALS[k] == str[i];" << std::endl;
+    out << "        } // end for" << std::endl << std::endl;
+    out << "        if (!valid)" << std::endl;
+    out << "            throw std::invalid_argument(\"Invalid terminal string.\");" << std::endl << std::endl;
+    out << "        const Variables variables = terminal(str[i]);" << std::endl;
+    out << "        for (unsigned int a = 0; a < VARIABLES; ++a) {" << std::endl;
+    out << "            if (variables.has(a))" << std::endl;
+    out << "                table.add(a, i, i + 1);" << std::endl;
+    out << "        } // end for" << std::endl;
+    out << "    } // end for" << std::endl << std::endl;
+    out << "    if (n == 0 || !HAS_START)" << std::endl;
+    out << "        return false;" << std::endl << std::endl;
+    out << "    for (std::size_t length = 2; length <= n; ++length) {" << std::endl;
+    out << "        for (std::size_t i = 0; i + length <= n; ++i) {" << std::endl;
+    out << "            const Variables variables = combine(table, i, i + length);" << std::endl << std::endl;
+    out << "            for (unsigned int a = 0; a < VARIABLES; ++a) {" << std::endl;
+    out << "                if (variables.has(a))" << std::endl;
+    out << "                    table.add(a, i, i + length);" << std::endl;
+    out << "            } // end for" << std::endl;
+    out << "        } // end for" << std::endl;
+    out << "    } // end for" << std::endl << std::endl;
+    out << "    return table.has(START, 0, n);" << std::endl;
+    out << "}" << std::endl << std::endl;
+
+    out << "} // end namespace" << std::endl << std::endl;
+    out << "#endif // " << guard << std::endl;
+}
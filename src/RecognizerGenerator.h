@@ -0,0 +1,54 @@
+/* RecognizerGenerator
+ * Generation of a C++ header with a CYK recognizer specialized for one CNF,
+ * for grammars that are fixed when the program is built.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_RECOGNIZERGENERATOR_H
+#define H_RECOGNIZERGENERATOR_H
+
+#include "CNF.h"
+#include <ostream>
+#include <string>
+
+/**
+ * @brief Write a header with a recognizer for the passed CNF, in namespace
+ * name. The header has no dependencies on the rest of the program:
+ * - constexpr tables of the production rules A --> BC and A --> a (as
+ *   variable ids), BINARY_RULES sorted on the body and TERMINAL_RULES sorted
+ *   on the terminal, the terminals (TERMINALS) and the start symbol (START),
+ * - Variables, a set of variables as bitset of WORDS 64 bit words, so there's
+ *   no limit on the amount of variables,
+ * - terminal(a), the set of variables A with A --> a, with a case for the
+ *   rules of each terminal in TERMINAL_RULES,
+ * - combine(table, i, j), the set of variables A with A --> BC, with one
+ *   unrolled check for the rules of each body in BINARY_RULES; a
+ *   static_assert makes sure that the checks and the tables agree,
+ * - recognize(str), the CYK algorithm on these, throwing
+ *   std::invalid_argument if str contains symbols that are not terminals.
+ *
+ * @param cnf The CNF.
+ * @param name The namespace of the recognizer, a C++ identifier.
+ * @param out The stream the header is written to.
+ * @param source The name of the file the CNF was read from, for the comment
+ * at the top of the header.
+ *
+ * @throw std::invalid_argument if name isn't an identifier.
+ */
+void generateRecognizer(const CNF& cnf, const std::string& name, std::ostream& out, const std::string& source = "");
+
+#endif // H_RECOGNIZERGENERATOR_H
@@ -1,7 +1,7 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "../LLParser.h"
-#include "../CNF.h"
+#include "StemLoopRecognizer.h"
 #include <sstream>
 #include <chrono>
 #include <ctime>
@@ -46,35 +46,12 @@ void MainWindow::on_AnalyzeButton_clicked(){
     int endIndex = 0;
     int stemSize = 0;
     if(algoType == "CFG"){
-        // it's as easy as a raspberry pi
-        std::set<char> terminals = {'A', 'G', 'U', 'C'};
-        std::set<char> variables = {'p', 'q'};
-        // (I'm using lowercased letters to avoid confusing the diff between
-        // variables and terminals
-        std::multimap<char, SymbolString> productions = {
-            {'p', "AqU"},
-            {'p', "UqA"},
-            {'p', "CqG"},
-            {'p', "GqC"},
-            {'p', "ApU"},
-            {'p', "UpA"},
-            {'p', "CpG"},
-            {'p', "GpC"},
-            {'q', "A"},
-            {'q', "U"},
-            {'q', "G"},
-            {'q', "C"},
-            {'q', "Aq"},
-            {'q', "Uq"},
-            {'q', "Gq"},
-            {'q', "Cq"}
-        };
-
+        // it's as easy as a raspberry pi: the recognizer of the stem loop
+        // grammar (data/StemLoop.xml) is generated when building, p --> AqU |
+        // UqA | CqG | GqC | ApU | UpA | CpG | GpC, q --> A | U | G | C | Aq |
+        // Uq | Gq | Cq
         try {
-            // let's build a CNF!
-            CNF cnf(terminals, variables, productions, 'p');
-
-            accepted = cnf.CYK(RNALoop); // that's it
+            accepted = StemLoop::recognize(RNALoop); // that's it
 
             if (accepted) {
                 std::string sequence = RNALoop;
@@ -0,0 +1,56 @@
+/* generateRecognizer
+ * Simple program that generates a header with a recognizer specialized for
+ * the grammar of a CFG or CNF XML file.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "CNF.h"
+#include "RecognizerGenerator.h"
+
+int main(int argc, char* argv[]) {
+    if (argc != 4) {
+        std::cout << "Usage:" << std::endl;
+        std::cout << '\t' << argv[0] << " [XML-FILE] [HEADER-FILE] [NAME]" << std::endl;
+        return 1;
+    } // end if
+
+    try {
+        const CNF cnf = generateCNF(argv[1]);
+
+        // the source without the directories, so the header doesn't depend
+        // on where it was built
+        std::string source = argv[1];
+        source = source.substr(source.find_last_of("/\\") + 1);
+
+        std::ofstream header(argv[2]);
+        if (!header)
+            throw std::runtime_error(std::string("Could not write ") + argv[2] + ".");
+
+        generateRecognizer(cnf, argv[3], header, source);
+
+        if (!header)
+            throw std::runtime_error(std::string("Could not write ") + argv[2] + ".");
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    } // end try-catch
+
+    return 0;
+}
@@ -0,0 +1,592 @@
+/* runBenchmark
+ * Simple program that times the different implementations of the algorithms
+ * on generated RNA sequences.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "CNF.h"
+#include "CYK.h"
+#include "Earley.h"
+#include "GLL.h"
+#include "IndexedGrammar.h"
+#include "PDA.h"
+#include "StemLoopRecognizer.h"
+
+namespace {
+
+/**
+ * @brief The stem loop grammar of the GUI.
+ */
+CNF stemLoop(const Binarization& binarization = BINARIZE_FRESH) {
+    std::set<char> terminals = {'A', 'G', 'U', 'C'};
+    std::set<char> variables = {'p', 'q'};
+    std::multimap<char, SymbolString> productions = {
+        {'p', "AqU"}, {'p', "UqA"}, {'p', "CqG"}, {'p', "GqC"},
+        {'p', "ApU"}, {'p', "UpA"}, {'p', "CpG"}, {'p', "GpC"},
+        {'q', "A"}, {'q', "U"}, {'q', "G"}, {'q', "C"},
+        {'q', "Aq"}, {'q', "Uq"}, {'q', "Gq"}, {'q', "Cq"}
+    };
+
+    return CNF(terminals, variables, productions, 'p', ProductionWeights(), binarization);
+}
+
+/**
+ * @brief Generate a stem loop of the passed length, the stem takes up about
+ * a third of the sequence.
+ */
+std::string sequence(const unsigned int& length, std::mt19937& random) {
+    const std::string nucleotides = "AGUC";
+    const std::string complements = "UCAG";
+    std::uniform_int_distribution<int> pick(0, 3);
+
+    std::string front, back;
+    for (unsigned int i = 0; i < length / 3; ++i) {
+        const int n = pick(random);
+        front += nucleotides.at(n);
+        back = complements.at(n) + back;
+    } // end for
+
+    std::string loop;
+    while (front.size() + loop.size() + back.size() < length) {
+        loop += nucleotides.at(pick(random));
+    } // end while
+
+    return front + loop + back;
+}
+
+/**
+ * @brief Time a function returning a bool, in seconds.
+ */
+template <class F>
+double time(F f, bool& result) {
+    const auto start = std::chrono::steady_clock::now();
+    result = f();
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/**
+ * @brief Compare CNF::CYK with the bitset engines on sequences of the passed
+ * lengths.
+ */
+void cyk(const std::vector<unsigned int>& lengths, const unsigned int& threads) {
+    const CNF cnf = stemLoop();
+    std::mt19937 random(42);
+
+    std::cout << std::setw(8) << "length"
+              << std::setw(14) << "classic (s)"
+              << std::setw(14) << "bitset (s)"
+              << std::setw(14) << "wavefront (s)"
+              << std::setw(14) << "matrix (s)"
+              << std::setw(14) << "viterbi (s)"
+              << std::setw(10) << "speedup" << std::endl;
+
+    const CYKGrammar grammar(cnf);
+
+    for (const unsigned int& length : lengths) {
+        const std::string s = sequence(length, random);
+
+        bool classic = false, bitset = false, wavefront = false, matrix = false, viterbi = false;
+        const double tc = time([&]() { return cnf.CYK(s); }, classic);
+        const double tb = time([&]() { return cnf.CYK(s, CYK_BITSET); }, bitset);
+        const double tw = time([&]() { return cnf.CYK(s, CYK_WAVEFRONT, threads); }, wavefront);
+        const double tm = time([&]() { return cnf.CYK(s, CYK_MATRIX); }, matrix);
+        const double tv = time([&]() { return CYKScore(grammar, s).accepted(); }, viterbi);
+
+        if (classic != bitset || classic != wavefront || classic != matrix || classic != viterbi)
+            throw std::runtime_error("The CYK engines disagree.");
+
+        std::cout << std::setw(8) << length
+                  << std::setw(14) << tc
+                  << std::setw(14) << tb
+                  << std::setw(14) << tw
+                  << std::setw(14) << tm
+                  << std::setw(14) << tv
+                  << std::setw(10) << tc / std::min(std::min(tb, tw), tm) << std::endl;
+    } // end for
+}
+
+/**
+ * @brief Time the banded CYK scanner on sequences of the passed lengths.
+ */
+void scan(const std::vector<unsigned int>& lengths, const unsigned int& span) {
+    const CNF cnf = stemLoop();
+    const CYKGrammar grammar(cnf);
+    std::mt19937 random(42);
+
+    std::cout << "span: " << span << std::endl;
+    std::cout << std::setw(10) << "length"
+              << std::setw(14) << "time (s)"
+              << std::setw(14) << "windows"
+              << std::setw(16) << "nt/s" << std::endl;
+
+    for (const unsigned int& length : lengths) {
+        // stem loops that fit in the span, one after the other
+        std::string s;
+        while (s.size() < length) {
+            s += sequence(std::min(span, length - unsigned(s.size())), random);
+        } // end while
+
+        unsigned long windows = 0;
+        bool done = false;
+        const double t = time([&]() {
+            CYKScanner scanner(grammar, span);
+
+            for (const char& c : s) {
+                windows += scanner.push(c).size();
+            } // end for
+
+            return true;
+        }, done);
+
+        std::cout << std::setw(10) << length
+                  << std::setw(14) << t
+                  << std::setw(14) << windows
+                  << std::setw(16) << length / t << std::endl;
+    } // end for
+}
+
+/**
+ * @brief Compare one CNF::CYK call per read with the batched CYK, for
+ * batches with the passed amounts of reads of 100 nucleotides.
+ */
+void batch(const std::vector<unsigned int>& counts, const unsigned int& threads) {
+    const CNF cnf = stemLoop();
+    std::mt19937 random(42);
+
+    std::cout << std::setw(10) << "reads"
+              << std::setw(14) << "single (s)"
+              << std::setw(14) << "batch (s)"
+              << std::setw(10) << "speedup" << std::endl;
+
+    for (const unsigned int& count : counts) {
+        std::vector<std::string> reads;
+        for (unsigned int i = 0; i < count; ++i) {
+            reads.push_back(sequence(100, random));
+        } // end for
+
+        std::vector<bool> single, batched;
+        bool done = false;
+
+        const double ts = time([&]() {
+            for (const std::string& r : reads) {
+                single.push_back(cnf.CYK(r, CYK_MATRIX));
+            } // end for
+
+            return true;
+        }, done);
+
+        const double tb = time([&]() {
+            batched = cnf.CYK(reads, threads);
+            return true;
+        }, done);
+
+        if (single != batched)
+            throw std::runtime_error("The CYK engines disagree.");
+
+        std::cout << std::setw(10) << count
+                  << std::setw(14) << ts
+                  << std::setw(14) << tb
+                  << std::setw(10) << ts / tb << std::endl;
+    } // end for
+}
+
+/**
+ * @brief Compare the ways to eleminate epsilon productions on the grammar
+ * A --> B...Ba, B --> b | epsilon, with bodies of the passed lengths.
+ */
+void epsilon(const std::vector<unsigned int>& lengths) {
+    // leaving out subsets takes too long for longer bodies
+    const unsigned int maxSubsets = 16;
+
+    std::cout << std::setw(8) << "length"
+              << std::setw(14) << "subsets (s)"
+              << std::setw(10) << "rules"
+              << std::setw(16) << "binarized (s)"
+              << std::setw(10) << "rules"
+              << std::setw(14) << "indexed (s)"
+              << std::setw(10) << "rules" << std::endl;
+
+    for (const unsigned int& length : lengths) {
+        const std::set<char> terminals = {'a', 'b'};
+        const std::set<char> variables = {'A', 'B'};
+        const std::multimap<char, SymbolString> productions = {
+            {'A', SymbolString(length, 'B') + 'a'}, {'B', ""}, {'B', "b"}
+        };
+
+        bool done = false;
+        std::size_t subsetRules = 0, binarizedRules = 0, indexedRules = 0;
+
+        double ts = 0;
+        if (length <= maxSubsets) {
+            ts = time([&]() {
+                CFG cfg(terminals, variables, productions, 'A');
+                cfg.cleanUp(EPSILON_SUBSETS);
+                subsetRules = cfg.getProductions().size();
+                return true;
+            }, done);
+        } // end if
+
+        const double tb = time([&]() {
+            CFG cfg(terminals, variables, productions, 'A');
+            cfg.cleanUp(EPSILON_BINARIZED);
+            binarizedRules = cfg.getProductions().size();
+            return true;
+        }, done);
+
+        const double ti = time([&]() {
+            IndexedGrammar g(CFG(terminals, variables, productions, 'A'));
+            g.cleanUp(EPSILON_BINARIZED);
+            indexedRules = g.productions();
+            return true;
+        }, done);
+
+        std::cout << std::setw(8) << length;
+
+        if (length <= maxSubsets) {
+            std::cout << std::setw(14) << ts << std::setw(10) << subsetRules;
+        } else {
+            std::cout << std::setw(14) << "-" << std::setw(10) << "-";
+        } // end if-else
+
+        std::cout << std::setw(16) << tb
+                  << std::setw(10) << binarizedRules
+                  << std::setw(14) << ti
+                  << std::setw(10) << indexedRules << std::endl;
+    } // end for
+}
+
+/**
+ * @brief Compare CNF::CYK with the Earley recognizer and the GLL parser on
+ * the CFG of the stem loop grammar, on sequences of the passed lengths.
+ */
+void earley(const std::vector<unsigned int>& lengths) {
+    const CNF cnf = stemLoop();
+    std::mt19937 random(42);
+
+    const std::set<char> terminals = {'A', 'G', 'U', 'C'};
+    const std::set<char> variables = {'p', 'q'};
+    const std::multimap<char, SymbolString> productions = {
+        {'p', "AqU"}, {'p', "UqA"}, {'p', "CqG"}, {'p', "GqC"},
+        {'p', "ApU"}, {'p', "UpA"}, {'p', "CpG"}, {'p', "GpC"},
+        {'q', "A"}, {'q', "U"}, {'q', "G"}, {'q', "C"},
+        {'q', "Aq"}, {'q', "Uq"}, {'q', "Gq"}, {'q', "Cq"}
+    };
+    const EarleyGrammar grammar(CFG(terminals, variables, productions, 'p'));
+
+    std::cout << std::setw(8) << "length"
+              << std::setw(14) << "classic (s)"
+              << std::setw(14) << "matrix (s)"
+              << std::setw(14) << "earley (s)"
+              << std::setw(12) << "items"
+              << std::setw(14) << "gll (s)"
+              << std::setw(12) << "forest" << std::endl;
+
+    for (const unsigned int& length : lengths) {
+        const std::string s = sequence(length, random);
+
+        bool classic = false, matrix = false, accepted = false, parsed = false;
+        std::size_t items = 0, forest = 0;
+        const double tc = time([&]() { return cnf.CYK(s); }, classic);
+        const double tm = time([&]() { return cnf.CYK(s, CYK_MATRIX); }, matrix);
+        const double te = time([&]() {
+            const EarleyRecognizer recognizer(grammar, s);
+            items = recognizer.items();
+            return recognizer.accepted();
+        }, accepted);
+        const double tg = time([&]() {
+            const GLLParse parse(grammar, s);
+            forest = parse.nodes() + parse.packedNodes();
+            return parse.accepted();
+        }, parsed);
+
+        if (classic != matrix || classic != accepted || classic != parsed)
+            throw std::runtime_error("The CYK engines disagree.");
+
+        std::cout << std::setw(8) << length
+                  << std::setw(14) << tc
+                  << std::setw(14) << tm
+                  << std::setw(14) << te
+                  << std::setw(12) << items
+                  << std::setw(14) << tg
+                  << std::setw(12) << forest << std::endl;
+    } // end for
+}
+
+/**
+ * @brief Compare the bit matrix CYK on the stem loop grammar with the
+ * recognizer generated for it at build time, on sequences of the passed
+ * lengths.
+ */
+void generated(const std::vector<unsigned int>& lengths) {
+    const CNF cnf = stemLoop();
+    const CYKGrammar grammar(cnf);
+    std::mt19937 random(42);
+
+    std::cout << std::setw(8) << "length"
+              << std::setw(14) << "matrix (s)"
+              << std::setw(16) << "generated (s)"
+              << std::setw(10) << "speedup" << std::endl;
+
+    for (const unsigned int& length : lengths) {
+        const std::string s = sequence(length, random);
+
+        bool matrix = false, recognized = false;
+        const double tm = time([&]() { return CYKMatrix(grammar, s).accepted(); }, matrix);
+        const double tg = time([&]() { return StemLoop::recognize(s); }, recognized);
+
+        if (matrix != recognized)
+            throw std::runtime_error("The CYK engines disagree.");
+
+        std::cout << std::setw(8) << length
+                  << std::setw(14) << tm
+                  << std::setw(16) << tg
+                  << std::setw(10) << tm / tg << std::endl;
+    } // end for
+}
+
+/**
+ * @brief The IDs PDA::process makes and throws away as duplicates, with the
+ * PDA of the GUI (data/PDARNA1.xml) and with the PDA based upon the stem loop
+ * grammar, against the PDA_SATURATION engine, on sequences of the passed
+ * lengths.
+ */
+void pda(const std::vector<unsigned int>& lengths) {
+    PDA rna(std::string(DATADIR) + "PDARNA1.xml");
+
+    const std::set<char> terminals = {'A', 'G', 'U', 'C'};
+    const std::set<char> variables = {'p', 'q'};
+    const std::multimap<char, SymbolString> productions = {
+        {'p', "AqU"}, {'p', "UqA"}, {'p', "CqG"}, {'p', "GqC"},
+        {'p', "ApU"}, {'p', "UpA"}, {'p', "CpG"}, {'p', "GpC"},
+        {'q', "A"}, {'q', "U"}, {'q', "G"}, {'q', "C"},
+        {'q', "Aq"}, {'q', "Uq"}, {'q', "Gq"}, {'q', "Cq"}
+    };
+    PDA grammar(CFG(terminals, variables, productions, 'p'));
+
+    std::mt19937 random(42);
+
+    std::cout << std::setw(8) << "length"
+              << std::setw(8) << "pda"
+              << std::setw(12) << "time (s)"
+              << std::setw(12) << "ids"
+              << std::setw(12) << "duplicates"
+              << std::setw(10) << "cut"
+              << std::setw(10) << "pruned"
+              << std::setw(18) << "saturation (s)" << std::endl;
+
+    for (const unsigned int& length : lengths) {
+        const std::string s = sequence(length, random);
+
+        for (int k = 0; k < 2; ++k) {
+            PDA& automaton = (k == 0) ? rna : grammar;
+
+            PDAStats stats;
+            bool accepted = false;
+            const double t = time([&]() { return automaton.process(s, stats); }, accepted);
+
+            bool saturated = false;
+            const double ts = time([&]() { return automaton.process(s, PDA_SATURATION); }, saturated);
+
+            if (accepted != saturated)
+                throw std::runtime_error("The PDA engines disagree.");
+
+            const double pruned = stats.ids == 0 ? 0.0 : 100.0 * stats.duplicates / stats.ids;
+
+            std::cout << std::setw(8) << length
+                      << std::setw(8) << (k == 0 ? "rna" : "cfg")
+                      << std::setw(12) << t
+                      << std::setw(12) << stats.ids
+                      << std::setw(12) << stats.duplicates
+                      << std::setw(10) << stats.cut
+                      << std::setw(9) << std::fixed << std::setprecision(1) << pruned << "%"
+                      << std::defaultfloat << std::setprecision(6)
+                      << std::setw(18) << ts << std::endl;
+        } // end for
+    } // end for
+}
+
+/**
+ * @brief Compare fresh and shared prefix variables when splitting long
+ * bodies, on the stem loop grammar and on the grammar S --> wS | w for the
+ * passed amounts of random words w of 6 nucleotides.
+ */
+void binarize(const std::vector<unsigned int>& counts) {
+    const std::string nucleotides = "AGUC";
+    const unsigned int wordLength = 6;
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> pick(0, 3);
+
+    std::cout << "stem loop rules: "
+              << stemLoop().getProductions().size() << " fresh, "
+              << stemLoop(BINARIZE_SHARED).getProductions().size()
+              << " shared" << std::endl;
+
+    std::cout << std::setw(8) << "words"
+              << std::setw(14) << "fresh rules"
+              << std::setw(14) << "fresh (s)"
+              << std::setw(14) << "shared rules"
+              << std::setw(14) << "shared (s)"
+              << std::setw(10) << "speedup" << std::endl;
+
+    for (const unsigned int& count : counts) {
+        IndexedGrammar g;
+        for (const char& n : nucleotides) {
+            g.addTerminal(n);
+        } // end for
+
+        const Symbol start = g.addVariable('S');
+        g.setStart(start);
+
+        std::vector<std::string> words;
+        for (unsigned int i = 0; i < count; ++i) {
+            std::string w;
+            std::vector<Symbol> body;
+
+            for (unsigned int k = 0; k < wordLength; ++k) {
+                w += nucleotides.at(pick(random));
+                body.push_back(IndexedGrammar::terminal(w.back()));
+            } // end for
+
+            words.push_back(w);
+            g.addProduction(start, body);
+
+            body.push_back(start);
+            g.addProduction(start, body);
+        } // end for
+
+        IndexedGrammar fresh = g, shared = g;
+        fresh.toCNF(EPSILON_BINARIZED, BINARIZE_FRESH);
+        shared.toCNF(EPSILON_BINARIZED, BINARIZE_SHARED);
+
+        const CYKGrammar freshGrammar(fresh), sharedGrammar(shared);
+
+        // 20 words, about 120 nucleotides
+        std::string s;
+        for (unsigned int i = 0; i < 20; ++i) {
+            s += words.at(random() % words.size());
+        } // end for
+
+        bool freshAccepted = false, sharedAccepted = false;
+        const double tf = time([&]() { return CYKMatrix(freshGrammar, s).accepted(); }, freshAccepted);
+        const double ts = time([&]() { return CYKMatrix(sharedGrammar, s).accepted(); }, sharedAccepted);
+
+        if (!freshAccepted || !sharedAccepted)
+            throw std::runtime_error("The CYK engines disagree.");
+
+        std::cout << std::setw(8) << count
+                  << std::setw(14) << fresh.productions()
+                  << std::setw(14) << tf
+                  << std::setw(14) << shared.productions()
+                  << std::setw(14) << ts
+                  << std::setw(10) << tf / ts << std::endl;
+    } // end for
+}
+
+} // end namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage:" << std::endl;
+        std::cout << '\t' << argv[0] << " cyk [LENGTH...]" << std::endl;
+        std::cout << '\t' << argv[0] << " scan [LENGTH...]" << std::endl;
+        std::cout << '\t' << argv[0] << " batch [READS...]" << std::endl;
+        std::cout << '\t' << argv[0] << " epsilon [LENGTH...]" << std::endl;
+        std::cout << '\t' << argv[0] << " binarize [WORDS...]" << std::endl;
+        std::cout << '\t' << argv[0] << " earley [LENGTH...]" << std::endl;
+        std::cout << '\t' << argv[0] << " generated [LENGTH...]" << std::endl;
+        std::cout << '\t' << argv[0] << " pda [LENGTH...]" << std::endl;
+        std::cout << "The amount of threads can be set with the THREADS environment variable," << std::endl;
+        std::cout << "the span of the scanner with the SPAN environment variable." << std::endl;
+        return 0;
+    } // end if
+
+    try {
+        const std::string benchmark = argv[1];
+
+        // 0 means one thread for each hardware thread
+        unsigned int threads = 0;
+        if (std::getenv("THREADS") != NULL)
+            threads = std::atoi(std::getenv("THREADS"));
+
+        std::vector<unsigned int> lengths;
+        for (int i = 2; i < argc; ++i) {
+            lengths.push_back(std::atoi(argv[i]));
+        } // end for
+
+        if (benchmark == "cyk") {
+            if (lengths.empty())
+                lengths = {25, 50, 100, 200};
+
+            cyk(lengths, threads);
+        } else if (benchmark == "scan") {
+            unsigned int span = 200;
+            if (std::getenv("SPAN") != NULL)
+                span = std::atoi(std::getenv("SPAN"));
+
+            if (lengths.empty())
+                lengths = {10000, 100000};
+
+            scan(lengths, span);
+        } else if (benchmark == "batch") {
+            if (lengths.empty())
+                lengths = {1000, 10000};
+
+            batch(lengths, threads);
+        } else if (benchmark == "epsilon") {
+            if (lengths.empty())
+                lengths = {4, 8, 12, 16, 100, 200};
+
+            epsilon(lengths);
+        } else if (benchmark == "binarize") {
+            if (lengths.empty())
+                lengths = {16, 64, 256, 1024};
+
+            binarize(lengths);
+        } else if (benchmark == "earley") {
+            if (lengths.empty())
+                lengths = {25, 50, 100, 200};
+
+            earley(lengths);
+        } else if (benchmark == "generated") {
+            if (lengths.empty())
+                lengths = {25, 50, 100, 200, 400};
+
+            generated(lengths);
+        } else if (benchmark == "pda") {
+            if (lengths.empty())
+                lengths = {10, 20, 40, 80};
+
+            pda(lengths);
+        } else {
+            std::cout << "Unknown benchmark " << benchmark << std::endl;
+        } // end if-else
+    } catch (const std::exception& e) {
+        std::cout << e.what() << std::endl;
+    } // end try-catch
+
+    return 0;
+}
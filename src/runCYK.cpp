@@ -20,148 +20,95 @@
  * Last modified: 09 December 2013.
  * By: Stijn Wouters.
  */
-#include "TinyXML/tinyxml.h"
 #include <stdexcept>
+#include <iomanip>
 #include <iostream>
-#include <algorithm>
 #include <string> 
+#include <vector>
 #include "CNF.h"
+#include "CNFCache.h"
+#include "CYK.h"
+
+namespace {
+
+// the size of the grammar after each stage of the conversion to CNF
+void printStats(const GrammarStats& stats) {
+    std::cout << std::setw(12) << "stage"
+              << std::setw(12) << "variables"
+              << std::setw(14) << "productions"
+              << std::setw(10) << "symbols"
+              << std::setw(14) << "time (s)" << std::endl;
+
+    for (const StageStats& stage : stats.stages) {
+        std::cout << std::setw(12) << stage.stage
+                  << std::setw(12) << stage.variables
+                  << std::setw(14) << stage.productions
+                  << std::setw(10) << stage.symbols
+                  << std::setw(14) << stage.seconds << std::endl;
+    } // end for
+}
+
+// the candidate pairs the CYK algorithm looked up
+void printStats(const CYKStats& stats) {
+    std::cout << "CYK: " << stats.cells << " cells, "
+              << stats.pairs << " candidate pairs ("
+              << (stats.cells == 0 ? 0.0 : double(stats.pairs) / stats.cells) << " per cell, at most "
+              << stats.maxPairs << "), "
+              << stats.matches << " matching a rule, "
+              << stats.seconds << " s" << std::endl;
+
+    std::cout << std::setw(12) << "length" << std::setw(14) << "pairs" << std::endl;
+    for (std::size_t l = 2; l < stats.pairsPerLength.size(); ++l) {
+        std::cout << std::setw(12) << l << std::setw(14) << stats.pairsPerLength[l] << std::endl;
+    } // end for
+}
+
+} // end namespace
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
+    // --stats may come anywhere
+    bool stats = false;
+    std::vector<std::string> arguments;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--stats")
+            stats = true;
+        else
+            arguments.push_back(argv[i]);
+    } // end for
+
+    if (arguments.size() != 2) {
         std::cout << "Usage:" << std::endl;
-        std::cout << '\t' << argv[0] << " [XML-FILE] [STRING]" << std::endl;
+        std::cout << '\t' << argv[0] << " [--stats] [XML-FILE] [STRING]" << std::endl;
     } else {
         try {
-            // start to parse
-            TiXmlDocument doc;
-            if (!doc.LoadFile(argv[1]))
-                throw std::runtime_error("XML file does not exist");
-
-            TiXmlElement* root = doc.FirstChildElement();
-
-            if (root == NULL) {
-                doc.Clear();
-                throw std::runtime_error("No root element");
-            } // end if
-
-            std::string rootname = root->Value();
-            std::transform(rootname.begin(), rootname.end(), rootname.begin(), ::tolower);
-
-            if ( !( (rootname == "cfg") || (rootname == "cnf") ) ) {
-                doc.Clear();
-                throw std::runtime_error("Not a CFG or CNF XML file.");
-            } // end if
-
-            // ok, now ACTUALLY parse the stuffs
-            std::set<char> terminals;
-            std::set<char> variables;
-            std::multimap<char, SymbolString> productions;
-            char start = 0;
-
-            for (TiXmlElement* el = root->FirstChildElement(); el != NULL; el = el->NextSiblingElement()) {
-                std::string elName = el->Value();
-                std::transform(elName.begin(), elName.end(), elName.begin(), ::tolower);
-
-                if (elName == "terminals") {
-                    TiXmlNode* n = el->FirstChild();
-                    TiXmlText* text = NULL;
-
-                    if (n != NULL)
-                        text = n->ToText();
-
-                    if (text == NULL)
-                        continue;
-
-                    std::string terms = text->Value();
-                    for (char t : terms) {
-                        terminals.insert(t);
-                    } // end for
-
-                } else if (elName == "variables") {
-                    TiXmlNode* n = el->FirstChild();
-                    TiXmlText* text = NULL;
-
-                    if (n != NULL)
-                        text = n->ToText();
-
-                    if (text == NULL)
-                        continue;
-
-                    std::string vars = text->Value();
-                    for (char v : vars) {
-                        variables.insert(v);
-                    } // end for
-
-                } else if (elName == "productions") {
-                    for (TiXmlElement* rule = el->FirstChildElement(); rule != NULL; rule = rule->NextSiblingElement()) {
-                        std::string ruleName = rule->Value();
-                        std::transform(ruleName.begin(), ruleName.end(), ruleName.begin(), ::tolower);
-
-                        if (ruleName == "rule") {
-                            char head = 0;
-
-                            for (TiXmlAttribute* attr = rule->FirstAttribute(); attr != NULL; attr = attr->Next()) {
-                                std::string attrName = attr->Name();
-                                std::transform(attrName.begin(), attrName.end(), attrName.begin(), ::tolower);
-
-                                if (attrName == "head") {
-                                    std::string headStr = attr->Value();
-
-                                    if (headStr.size() == 1)
-                                        head = headStr.front();
-                                } else {
-                                    // ignore other information
-                                } // end if-else
-                            } // end for
-
-                            TiXmlNode* n = rule->FirstChild();
-                            TiXmlText* text = NULL;
-
-                            if (n != NULL)
-                                text = n->ToText();
-
-                            std::string body;
-
-                            if (text == NULL) {
-                                body = "";
-                            } else {
-                                body = text->Value();
-                            } // end if-else
-
-                            productions.insert(std::pair<char, SymbolString>(head, body));
-                        } else  {
-                            // ignore other information
-                        } // end if-else
-                    } // end for
-                } else if (elName == "start") {
-                    TiXmlNode* n = el->FirstChild();
-                    TiXmlText* text = NULL;
+            // the converted grammar is cached next to the XML file, but a
+            // cached one didn't go through the stages
+            CNF cnf = stats ? generateCNF(arguments[0]) : cachedCNF(arguments[0]);
 
-                    if (n != NULL)
-                        text = n->ToText();
-
-                    if (text == NULL)
-                        continue;
-
-                    std::string symbol = text->Value();
-
-                    if (symbol.size() == 1)
-                        start = symbol.front();
-                } else {
-                    // ignore node
-                } // end if-else
-            } // end for
+            if (stats)
+                printStats(cnf.getStats());
 
             // now check the string
-            std::string sequence = argv[2];
-            CNF cnf(terminals, variables, productions, start);
-            if (cnf.CYK(sequence)) {
+            std::string sequence = arguments[1];
+            CYKStats cykStats;
+
+            if (cnf.CYK(sequence, cykStats)) {
                 std::cout << "\033[1;32mYES!\033[0m" << std::endl;
+
+                // also give the weight of the best derivation
+                if (cnf.isWeighted()) {
+                    CYKGrammar grammar(cnf);
+                    CYKScore score(grammar, sequence);
+                    std::cout << "Log weight of the best derivation: " << score.viterbi() << std::endl;
+                } // end if
             } else {
                 std::cout << "\033[1;31mNO!\033[0m" << std::endl;
             } // end if-else
 
+            if (stats)
+                printStats(cykStats);
+
         } catch (const std::exception& e) {
             std::cout << e.what() << std::endl;
         } // end try-catch
@@ -24,6 +24,7 @@
 #include <set>
 #include <map>
 #include <stdexcept>
+#include <algorithm>
 
 TEST_CASE("Constructing CFG's", "[CFG]") {
     const std::set<char> empty_set;
@@ -120,6 +121,19 @@ TEST_CASE("Bodies of the production rules", "[CFG]") {
         CHECK_THROWS_AS(c1.bodies('a'), std::invalid_argument);
         CHECK_THROWS_AS(c1.bodies('b'), std::invalid_argument);
         CHECK_THROWS_AS(c1.bodies('C'), std::invalid_argument);
+
+        // the view gives the same bodies in the same order, also when a
+        // production rule is passed twice
+        std::multimap<char, SymbolString> twice = productions;
+        twice.insert(std::pair<char, SymbolString>('A', "AB"));
+        const CFG c2(terminals, variables, twice, 'A');
+
+        const BodyRange range = c2.bodyRange('A');
+        CHECK(range.size() == A_bodies.size());
+        CHECK(std::equal(range.begin(), range.end(), A_bodies.begin()));
+        CHECK(c2.bodyRange('B').empty());
+        CHECK_THROWS_AS(c2.bodyRange('a'), std::invalid_argument);
+        CHECK(c2.getProductions().size() == productions.size());
     } catch (const std::invalid_argument& e) {
         FAIL("Could not construct CFG's: " << e.what());
     } // end try-catch
@@ -200,6 +214,65 @@ TEST_CASE("Eleminate epsilon productions", "[CFG]") {
         CHECK(c2.nullable().empty());
         CHECK(c2.bodies('A') == A_bodies_not_nullable2);
         CHECK(c2.bodies('B').empty());
+
+        // the bodies of each head stay sorted
+        const BodyRange range = c2.bodyRange('A');
+        CHECK(range.size() == A_bodies_not_nullable2.size());
+        CHECK(std::equal(range.begin(), range.end(), A_bodies_not_nullable2.begin()));
+        CHECK(c2.getProductions().size() == A_bodies_not_nullable2.size());
+    } catch (const std::invalid_argument& e) {
+        FAIL("Could not construct CFG's: " << e.what());
+    } // end try-catch
+}
+
+TEST_CASE("Eleminate epsilon productions (binarized)", "[CFG]") {
+    const std::set<char> terminals = {'a', 'b'};
+    const std::set<char> variables = {'A', 'B'};
+
+    // the head of a rule with a nullable body symbol needn't be nullable
+    const std::multimap<char, SymbolString> B_nullable = {
+                                                        {'A', "aB"},
+                                                        {'B', ""},
+                                                        {'B', "b"}
+                                                        };
+    const std::multimap<char, SymbolString> three_nullable = {
+                                                        {'A', "BBB"},
+                                                        {'B', ""},
+                                                        {'B', "b"}
+                                                        };
+
+    try {
+        std::set<SymbolString> A_bodies = {"a", "aB"};
+        CFG c0(terminals, variables, B_nullable, 'A');
+        c0.eleminateEpsilonProductions();
+        CHECK(c0.bodies('A') == A_bodies);
+
+        CFG c1(terminals, variables, B_nullable, 'A');
+        c1.eleminateEpsilonProductions(EPSILON_BINARIZED);
+        CHECK(c1.bodies('A') == A_bodies);
+
+        // BBB becomes B V, V --> BB with V the first free character
+        const char v = 1;
+        std::set<SymbolString> A_bodies_binarized = {"B", SymbolString(1, v), SymbolString("B") + v};
+        std::set<SymbolString> V_bodies_binarized = {"B", "BB"};
+        CFG c2(terminals, variables, three_nullable, 'A');
+        c2.eleminateEpsilonProductions(EPSILON_BINARIZED);
+        CHECK(c2.nullable().empty());
+        CHECK(c2.getVariables().size() == 3);
+        CHECK(c2.bodies('A') == A_bodies_binarized);
+        CHECK(c2.bodies(v) == V_bodies_binarized);
+
+        // 20 nullable symbols: 2^20 bodies for EPSILON_SUBSETS, but only a
+        // quadratic amount of rules after cleaning up
+        std::multimap<char, SymbolString> twenty_nullable = {
+                                                        {'A', SymbolString(20, 'B') + 'a'},
+                                                        {'B', ""},
+                                                        {'B', "b"}
+                                                        };
+        CFG c3(terminals, variables, twenty_nullable, 'A');
+        c3.cleanUp(EPSILON_BINARIZED);
+        CHECK(c3.nullable().empty());
+        CHECK(c3.getProductions().size() <= 21 * 22);
     } catch (const std::invalid_argument& e) {
         FAIL("Could not construct CFG's: " << e.what());
     } // end try-catch
@@ -241,6 +314,36 @@ TEST_CASE("Unit pairs", "[CFG]") {
 
         const CFG c2(terminals, variables, cyclic_productions, 'A');
         CHECK_THROWS_AS(c2.units(), std::runtime_error);
+
+        // the closure allows cycles, every variable of A, B and C reaches
+        // the others
+        CHECK(c0.unitClosure() == empty_units);
+        CHECK(c1.unitClosure() == productions_units);
+
+        std::set<std::pair<char, char>> cyclic_units;
+        for (const char& v : variables) {
+            for (const char& w : variables) {
+                cyclic_units.insert(std::pair<char, char>(v, w));
+            } // end for
+        } // end for
+        CHECK(c2.unitClosure() == cyclic_units);
+
+        // A --> B, B --> A | C, C --> D, D --> C | a, E --> A
+        const std::set<char> more_variables = {'A', 'B', 'C', 'D', 'E'};
+        const std::multimap<char, SymbolString> components = {
+                                                        {'A', "B"},
+                                                        {'B', "A"},
+                                                        {'B', "C"},
+                                                        {'C', "D"},
+                                                        {'D', "C"},
+                                                        {'D', "a"},
+                                                        {'E', "A"}
+                                                        };
+        const CFG c3(terminals, more_variables, components, 'E');
+        const std::set<std::pair<char, char>> closure = c3.unitClosure();
+        CHECK(closure.size() == 4 + 4 + 2 + 2 + 5);
+        CHECK(closure.count(std::pair<char, char>('E', 'D')) == 1);
+        CHECK(closure.count(std::pair<char, char>('C', 'B')) == 0);
     } catch (const std::invalid_argument& e) {
         FAIL("Could not construct CFG's: " << e.what());
     } // end try-catch
@@ -301,6 +404,21 @@ TEST_CASE("Eleminating unit productions", "[CFG]") {
 
         CFG c2(terminals, variables, cyclic_productions, 'A');
         CHECK_THROWS_AS(c2.eleminateUnitProductions(), std::runtime_error);
+
+        // A --> B | a, B --> A | b: both get the bodies a and b
+        const std::multimap<char, SymbolString> cycle_with_bodies = {
+                                                        {'A', "B"},
+                                                        {'A', "a"},
+                                                        {'B', "A"},
+                                                        {'B', "b"}
+                                                        };
+        std::set<SymbolString> a_b = {"a", "b"};
+        CFG c3(terminals, variables, cycle_with_bodies, 'A');
+        c3.eleminateUnitProductions(UNITS_CONDENSED);
+        CHECK(c3.units() == empty_units);
+        CHECK(c3.bodies('A') == a_b);
+        CHECK(c3.bodies('B') == a_b);
+        CHECK(c3.bodies('C').empty());
     } catch (const std::invalid_argument& e) {
         FAIL("Could not construct CFG's: " << e.what());
     } // end try-catch
@@ -355,6 +473,55 @@ TEST_CASE("Reachable symbols", "[CFG]") {
     } // end try-catch
 }
 
+TEST_CASE("Fixpoints on long chains", "[CFG]") {
+    // X(i) --> X(i+1) X(i+1) | a X(i+1), the last one X(n-1) --> "" and a
+    // variable Y --> Y X(0) that is reachable but not generating
+    const std::set<char> terminals = {'a'};
+    std::set<char> variables = {'Y'};
+    std::multimap<char, SymbolString> productions = {{'Y', "Y"}};
+
+    const unsigned int n = 120;
+    for (unsigned int i = 0; i < n; ++i) {
+        const char x = static_cast<char>(128 + i);
+        variables.insert(x);
+
+        if (i + 1 < n) {
+            const char next = static_cast<char>(128 + i + 1);
+            productions.insert(std::pair<char, SymbolString>(x, SymbolString(2, next)));
+            productions.insert(std::pair<char, SymbolString>(x, SymbolString("a") + next));
+        } else {
+            productions.insert(std::pair<char, SymbolString>(x, ""));
+        } // end if-else
+    } // end for
+    productions.insert(std::pair<char, SymbolString>('Y', SymbolString("Y") + static_cast<char>(128)));
+
+    try {
+        const CFG c0(terminals, variables, productions, 'Y');
+
+        std::set<char> nullables = variables;
+        nullables.erase('Y');
+        CHECK(c0.nullable() == nullables);
+
+        std::set<char> generating = nullables;
+        generating.insert('a');
+        CHECK(c0.generating() == generating);
+
+        std::set<char> reachable = variables;
+        reachable.insert('a');
+        CHECK(c0.reachable() == reachable);
+
+        // Y --> Y is a cycle of unit productions
+        CHECK_THROWS_AS(c0.units(), std::runtime_error);
+
+        productions.erase('Y');
+        const CFG c1(terminals, variables, productions, static_cast<char>(128));
+        CHECK(c1.units().size() == variables.size());
+        CHECK(c1.reachable() == generating);
+    } catch (const std::invalid_argument& e) {
+        FAIL("Could not construct CFG's: " << e.what());
+    } // end try-catch
+}
+
 TEST_CASE("Eleminating useless symbols", "[CFG]") {
     const std::set<char> terminals = {'a', 'b'};
     const std::set<char> variables = {'A', 'B', 'S'};
@@ -489,6 +656,26 @@ TEST_CASE("Clean up CFG", "[CFG]") {
         CHECK(c1.bodies('B') == B_productions_cleanup);
         CHECK_THROWS_AS(c0.bodies('C'), std::invalid_argument);
         CHECK(c1.bodies('S') == S_productions_cleanup);
+
+        // S --> A | aa, A --> S | bb: by default the unit cycle is collapsed,
+        // UNITS_ACYCLIC still throws
+        const std::multimap<char, SymbolString> cyclic = {
+                                                        {'S', "A"},
+                                                        {'S', "aa"},
+                                                        {'A', "S"},
+                                                        {'A', "bb"}
+                                                        };
+        std::set<SymbolString> cycle_productions_cleanup = {"aa", "bb"};
+        std::set< std::pair<char, char> > cycle_units_cleanup = {{'S', 'S'}};
+        CFG c2(terminals, variables, cyclic, 'S');
+        CHECK_THROWS_AS(c2.units(), std::runtime_error);
+        c2.cleanUp();
+        CHECK(c2.units() == cycle_units_cleanup);
+        CHECK(c2.bodies('S') == cycle_productions_cleanup);
+        CHECK_THROWS_AS(c2.bodies('A'), std::invalid_argument);
+
+        CFG c3(terminals, variables, cyclic, 'S');
+        CHECK_THROWS_AS(c3.cleanUp(EPSILON_SUBSETS, UNITS_ACYCLIC), std::runtime_error);
     } catch (const std::invalid_argument& e) {
         FAIL("Could not construct CFG's: " << e.what());
     } // end try-catch
@@ -24,6 +24,8 @@
 #include <set>
 #include <map>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 TEST_CASE("Constructing CNF", "[CNF]") {
     const std::set<char> empty_set;
@@ -111,3 +113,58 @@ TEST_CASE("CYK", "[CNF]") {
         FAIL("Could not construct CNF's: " << e.what());
     } // end try-catch
 }
+
+TEST_CASE("Grammar and CYK stats", "[CNF]") {
+    const std::set<char> terminals = {'a', 'b'};
+    const std::set<char> variables = {'A', 'B', 'S'};
+    const std::multimap<char, SymbolString> productions = {
+                                                        {'S', "A"},
+                                                        {'S', "B"},
+                                                        {'A', "aAa"},
+                                                        {'A', ""},
+                                                        {'B', "bBb"},
+                                                        {'B', ""}
+                                                        };
+
+    const CNF c(terminals, variables, productions, 'S');
+    const std::vector<StageStats>& stages = c.getStats().stages;
+
+    REQUIRE(6 == stages.size());
+    CHECK("input" == stages[0].stage);
+    CHECK("epsilon" == stages[1].stage);
+    CHECK("unit" == stages[2].stage);
+    CHECK("useless" == stages[3].stage);
+    CHECK("terminals" == stages[4].stage);
+    CHECK("binarize" == stages[5].stage);
+
+    CHECK(3 == stages[0].variables);
+    CHECK(6 == stages[0].productions);
+    CHECK(8 == stages[0].symbols);
+
+    // the last stage is the CNF itself
+    CHECK(c.getVariables().size() == stages.back().variables);
+    CHECK(c.getProductions().size() == stages.back().productions);
+
+    for (const StageStats& stage : stages) {
+        CHECK(stage.seconds >= 0);
+    } // end for
+
+    // a weighted CNF also computes the weights first
+    const ProductionWeights weights = {{{'A', "aAa"}, 0.5}};
+    CHECK("weights" == CNF(terminals, variables, productions, 'S', weights).getStats().stages[1].stage);
+
+    CYKStats stats;
+    CHECK(c.CYK("aaaa", stats));
+    CHECK(c.CYK("aaaa") == c.CYK("aaaa", stats));
+
+    // the cells of the substrings of length 2, 3 and 4
+    CHECK(6 == stats.cells);
+    REQUIRE(5 == stats.pairsPerLength.size());
+    CHECK(stats.pairs == stats.pairsPerLength[2] + stats.pairsPerLength[3] + stats.pairsPerLength[4]);
+    CHECK(stats.maxPairs <= stats.pairs);
+    CHECK(stats.matches <= stats.pairs);
+    CHECK(stats.matches > 0);
+
+    CHECK_FALSE(c.CYK("abab", stats));
+    CHECK_THROWS_AS(c.CYK("aacaa", stats), std::invalid_argument);
+}
@@ -0,0 +1,114 @@
+/* Test CNFCache
+ * Test writing and reading the binary cache files of CNF's.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Catch.h"
+#include "CNF.h"
+#include "CNFCache.h"
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+TEST_CASE("CNF cache files", "[CNFCache]") {
+    const std::string xml = std::string(DATADIR) + "StemLoop.xml";
+    const std::string cache = "test_StemLoop.cnf";
+    std::remove(cache.c_str());
+
+    const CNF cnf = generateCNF(xml);
+
+    SECTION("Save and load") {
+        saveCNF(cnf, cache, 42);
+
+        const CNF loaded = loadCNF(cache, 42);
+        CHECK(loaded.getTerminals() == cnf.getTerminals());
+        CHECK(loaded.getVariables() == cnf.getVariables());
+        CHECK(loaded.getProductions() == cnf.getProductions());
+        CHECK(loaded.getStartsymbol() == cnf.getStartsymbol());
+        REQUIRE(loaded.isWeighted());
+
+        for (const auto& p : cnf.getProductions()) {
+            CHECK(loaded.weight(p.first, p.second) == cnf.weight(p.first, p.second));
+        } // end for
+
+        CHECK(loaded.CYK("GGAAAACC") == cnf.CYK("GGAAAACC"));
+        CHECK(loaded.CYK("GGAAAACU") == cnf.CYK("GGAAAACU"));
+
+        // any hash, another hash
+        CHECK(loadCNF(cache).getProductions() == cnf.getProductions());
+        CHECK_THROWS_AS(loadCNF(cache, 43), std::runtime_error);
+    }
+
+    SECTION("Unweighted") {
+        const std::set<char> terminals = {'a', 'b'};
+        const std::set<char> variables = {'S'};
+        const std::multimap<char, SymbolString> productions = {
+                                                            {'S', "aSb"},
+                                                            {'S', ""}
+                                                            };
+        const CNF anbn(terminals, variables, productions, 'S');
+        saveCNF(anbn, cache);
+
+        const CNF loaded = loadCNF(cache);
+        CHECK_FALSE(loaded.isWeighted());
+        CHECK(loaded.getProductions() == anbn.getProductions());
+        CHECK(loaded.CYK("aabb"));
+        CHECK_FALSE(loaded.CYK("aab"));
+    }
+
+    SECTION("Invalid files") {
+        CHECK_THROWS_AS(loadCNF("test_does_not_exist.cnf"), std::runtime_error);
+
+        // not a cache file at all
+        CHECK_THROWS_AS(loadCNF(xml), std::runtime_error);
+
+        // a truncated cache file
+        saveCNF(cnf, cache);
+        std::string contents;
+        {
+            std::ifstream file(cache.c_str(), std::ios::binary);
+            contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        {
+            std::ofstream file(cache.c_str(), std::ios::binary | std::ios::trunc);
+            file.write(contents.data(), contents.size() - 1);
+        }
+        CHECK_THROWS_AS(loadCNF(cache), std::runtime_error);
+    }
+
+    SECTION("Cached XML files") {
+        // the first time the cache file is written, the second time read
+        const CNF first = cachedCNF(xml, cache);
+        CHECK(first.getProductions() == cnf.getProductions());
+        CHECK(loadCNF(cache, hashFile(xml)).getProductions() == cnf.getProductions());
+
+        const CNF second = cachedCNF(xml, cache);
+        CHECK(second.getProductions() == cnf.getProductions());
+
+        // a cache file of another source is replaced
+        saveCNF(cnf, cache, hashFile(xml) + 1);
+        CHECK(cachedCNF(xml, cache).getProductions() == cnf.getProductions());
+        CHECK(loadCNF(cache, hashFile(xml)).isWeighted());
+
+        CHECK(hashFile(xml) != hashFile(std::string(DATADIR) + "PDA.xml"));
+        CHECK_THROWS_AS(cachedCNF("test_does_not_exist.xml", cache), std::runtime_error);
+    }
+
+    std::remove(cache.c_str());
+}
@@ -0,0 +1,527 @@
+/* Test CYK
+ * Test the table based CYK engines.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Catch.h"
+#include "CNF.h"
+#include "CYK.h"
+#include "test_Helpers.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <map>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// the stem loop grammar of the GUI
+CNF stemLoop() {
+    const std::set<char> terminals = {'A', 'G', 'U', 'C'};
+    const std::set<char> variables = {'p', 'q'};
+    const std::multimap<char, SymbolString> productions = {
+        {'p', "AqU"}, {'p', "UqA"}, {'p', "CqG"}, {'p', "GqC"},
+        {'p', "ApU"}, {'p', "UpA"}, {'p', "CpG"}, {'p', "GpC"},
+        {'q', "A"}, {'q', "U"}, {'q', "G"}, {'q', "C"},
+        {'q', "Aq"}, {'q', "Uq"}, {'q', "Gq"}, {'q', "Cq"}
+    };
+
+    return CNF(terminals, variables, productions, 'p');
+}
+
+} // end namespace
+
+TEST_CASE("CYK bitset engine", "[CYK]") {
+    const std::set<char> terminals = {'a', 'b'};
+    const std::set<char> variables = {'A', 'B', 'C', 'S'};
+    const std::multimap<char, SymbolString> productions = {
+                                                        {'S', "A"},
+                                                        {'S', "B"},
+                                                        {'A', "aAa"},
+                                                        {'A', ""},
+                                                        {'B', "bBb"},
+                                                        {'B', ""},
+                                                        {'C', "aCa"},
+                                                        {'C', "bCb"}
+                                                        };
+
+    try {
+        CNF c(terminals, variables, productions, 'S');
+
+        CHECK_THROWS_AS(c.CYK("aacaa", CYK_BITSET), std::invalid_argument);
+        CHECK(c.CYK("aaaa", CYK_BITSET));
+        CHECK(c.CYK("bbbb", CYK_BITSET));
+        CHECK_FALSE(c.CYK("abab", CYK_BITSET));
+        CHECK_FALSE(c.CYK("", CYK_BITSET));
+
+        for (const std::string& s : test::strings("ab", 8)) {
+            CHECK(c.CYK(s, CYK_BITSET) == c.CYK(s));
+        } // end for
+
+        const CNF rna = stemLoop();
+        for (const std::string& s : test::strings("AGUC", 6)) {
+            CHECK(rna.CYK(s, CYK_BITSET) == rna.CYK(s));
+        } // end for
+
+        // the table knows about every substring, not only the whole string
+        const CYKGrammar grammar(rna);
+        const CYKTable table(grammar, "AGCAAGCUU");
+        CHECK(table.accepted());
+        CHECK(table.derives(grammar.start(), 4, 6));
+        CHECK_FALSE(table.derives(grammar.start(), 2, 3));
+    } catch (const std::invalid_argument& e) {
+        FAIL("Could not construct CNF's: " << e.what());
+    } // end try-catch
+}
+
+TEST_CASE("CYK wavefront engine", "[CYK]") {
+    const CNF rna = stemLoop();
+
+    CHECK_THROWS_AS(rna.CYK("AGXU", CYK_WAVEFRONT, 2), std::invalid_argument);
+    CHECK_FALSE(rna.CYK("", CYK_WAVEFRONT, 2));
+
+    for (const std::string& s : test::strings("AGUC", 5)) {
+        CHECK(rna.CYK(s, CYK_WAVEFRONT, 3) == rna.CYK(s, CYK_BITSET));
+    } // end for
+
+    // more threads than cells on most diagonals
+    CHECK(rna.CYK("GGCAUAAGCC", CYK_WAVEFRONT, 16));
+    CHECK_FALSE(rna.CYK("GGCAUAAGCA", CYK_WAVEFRONT, 16));
+
+    // one pool for many tables and batches
+    const CYKGrammar grammar(rna);
+    CYKPool pool(4);
+    REQUIRE(pool.size() == 4);
+
+    for (const std::string& s : test::strings("AGUC", 4)) {
+        CHECK(CYKTable(grammar, s, pool).accepted() == rna.CYK(s));
+    } // end for
+
+    const std::vector<std::string> batch = {"GGCAUAAGCC", "GGCAUAAGCA", "GCA"};
+    const std::vector<bool> expected = {true, false, false};
+    CHECK(batchCYK(grammar, batch, pool) == expected);
+    CHECK(&CYKPool::shared(3) == &CYKPool::shared(3));
+}
+
+TEST_CASE("CYK matrix engine", "[CYK]") {
+    // the grammar of test_CNF.cpp
+    const std::set<char> terminals = {'a', 'b'};
+    const std::set<char> variables = {'A', 'B', 'C', 'S'};
+    const std::multimap<char, SymbolString> productions = {
+                                                        {'S', "A"},
+                                                        {'S', "B"},
+                                                        {'A', "aAa"},
+                                                        {'A', ""},
+                                                        {'B', "bBb"},
+                                                        {'B', ""},
+                                                        {'C', "aCa"},
+                                                        {'C', "bCb"}
+                                                        };
+
+    try {
+        CNF c(terminals, variables, productions, 'S');
+
+        CHECK_THROWS_AS(c.CYK("aacaa", CYK_MATRIX), std::invalid_argument);
+        CHECK(c.CYK("aaaa", CYK_MATRIX));
+        CHECK(c.CYK("bbbb", CYK_MATRIX));
+        CHECK_FALSE(c.CYK("abab", CYK_MATRIX));
+        CHECK_FALSE(c.CYK("", CYK_MATRIX));
+
+        for (const std::string& s : test::strings("ab", 8)) {
+            CHECK(c.CYK(s, CYK_MATRIX) == c.CYK(s));
+        } // end for
+
+        const CNF rna = stemLoop();
+        for (const std::string& s : test::strings("AGUC", 6)) {
+            CHECK(rna.CYK(s, CYK_MATRIX) == rna.CYK(s));
+        } // end for
+
+        // long enough to span multiple words in a row
+        std::string stem, loop, back;
+        for (unsigned int i = 0; i < 70; ++i) {
+            stem += "GAUC"[i % 4];
+            back = "CUAG"[i % 4] + back;
+            loop += 'A';
+        } // end for
+        CHECK(rna.CYK(stem + loop + back, CYK_MATRIX));
+        CHECK_FALSE(rna.CYK(stem + loop + back + 'A', CYK_MATRIX));
+
+        const CYKGrammar grammar(rna);
+        const CYKTable table(grammar, stem + loop + back);
+        const CYKMatrix matrix(grammar, stem + loop + back);
+        for (unsigned int l = 1; l <= table.length(); l += 7) {
+            for (unsigned int i = 1; i + l - 1 <= table.length(); i += 5) {
+                CHECK(matrix.derives(grammar.start(), i, l) == table.derives(grammar.start(), i, l));
+            } // end for
+        } // end for
+    } catch (const std::invalid_argument& e) {
+        FAIL("Could not construct CNF's: " << e.what());
+    } // end try-catch
+}
+
+TEST_CASE("Accepted substrings", "[CYK]") {
+    typedef std::pair<unsigned int, unsigned int> Interval;
+    const CNF rna = stemLoop();
+
+    // overlapping stem loops, with shorter ones inside of them
+    const std::string s = "GCAAGCUU";
+    const std::vector<Interval> all = rna.acceptedSubstrings(s);
+    const std::vector<Interval> maximal = rna.acceptedSubstrings(s, true);
+
+    // compare with a CYK run for each substring
+    std::vector<Interval> expected;
+    for (unsigned int i = 1; i <= s.size(); ++i) {
+        for (unsigned int j = i; j <= s.size(); ++j) {
+            if (rna.CYK(s.substr(i - 1, j - i + 1)))
+                expected.push_back(Interval(i, j));
+        } // end for
+    } // end for
+
+    CHECK(all == expected);
+
+    for (const Interval& a : all) {
+        // each accepted substring is part of a maximal one
+        bool covered = false;
+
+        for (const Interval& m : maximal) {
+            if (m.first <= a.first && a.second <= m.second)
+                covered = true;
+        } // end for
+
+        CHECK(covered);
+    } // end for
+
+    for (const Interval& m : maximal) {
+        // and the maximal ones aren't part of each other
+        for (const Interval& o : maximal) {
+            if (m != o)
+                CHECK_FALSE((o.first <= m.first && m.second <= o.second));
+        } // end for
+    } // end for
+
+    CHECK(rna.acceptedSubstrings("AAAA").empty());
+    CHECK(rna.acceptedSubstrings("").empty());
+    CHECK_THROWS_AS(rna.acceptedSubstrings("AXU"), std::invalid_argument);
+}
+
+TEST_CASE("Banded CYK scanner", "[CYK]") {
+    typedef std::pair<unsigned int, unsigned int> Interval;
+    const CNF rna = stemLoop();
+    const CYKGrammar grammar(rna);
+
+    CHECK_THROWS_AS(CYKScanner(grammar, 0), std::invalid_argument);
+
+    // a sequence that is longer than the ring, with a few stem loops in it
+    std::string s;
+    for (unsigned int i = 0; i < 30; ++i) {
+        s += "GGCAUAAGCCAUUAGCAGCUAAUG"[(i * 7) % 24];
+        s += "AUGCCUUAGGC";
+    } // end for
+
+    for (const unsigned int& span : {1u, 5u, 12u, 64u, 100u}) {
+        CYKScanner scanner(grammar, span);
+
+        std::vector<Interval> windows;
+        for (const char& c : s) {
+            for (const Interval& w : scanner.push(c)) {
+                windows.push_back(w);
+            } // end for
+        } // end for
+
+        CHECK(scanner.position() == s.size());
+
+        // the same as the accepted substrings of at most span terminals
+        std::vector<Interval> expected;
+        for (const Interval& a : rna.acceptedSubstrings(s)) {
+            if (a.second - a.first + 1 <= span)
+                expected.push_back(a);
+        } // end for
+
+        std::sort(windows.begin(), windows.end());
+        CHECK(windows == expected);
+    } // end for
+
+    // streaming, skipping white space
+    std::istringstream in("GGCAU\nAAGCC\n");
+    CYKScanner scanner(grammar, 10);
+    std::vector<Interval> windows;
+    scanner.scan(in, [&](const Interval& w) { windows.push_back(w); });
+    CHECK(std::find(windows.begin(), windows.end(), Interval(1, 10)) != windows.end());
+
+    std::istringstream invalid("GGXU");
+    CHECK_THROWS_AS(scanner.scan(invalid, [](const Interval&) {}), std::invalid_argument);
+}
+
+TEST_CASE("Incremental CYK session", "[CYK]") {
+    const CNF rna = stemLoop();
+    const CYKGrammar grammar(rna);
+    CYKSession session(grammar);
+
+    CHECK(session.length() == 0);
+    CHECK_FALSE(session.accepted());
+
+    // long enough to need more than one word per row
+    std::string s;
+    for (unsigned int i = 0; i < 150; ++i) {
+        s += "GGCAUAAGCCAUUAGCAGCUAAUGC"[(i * 7) % 25];
+    } // end for
+
+    for (unsigned int j = 1; j <= s.size(); ++j) {
+        session.append(s.at(j - 1));
+
+        CHECK(session.length() == j);
+        CHECK(session.accepted() == rna.CYK(s.substr(0, j), CYK_MATRIX));
+
+        // a few of the suffixes
+        for (unsigned int i = 1; i <= j; i += 13) {
+            CHECK(session.accepted(i) == rna.CYK(s.substr(i - 1, j - i + 1), CYK_MATRIX));
+        } // end for
+    } // end for
+
+    CHECK_THROWS_AS(session.append('X'), std::invalid_argument);
+    CHECK(session.length() == s.size());
+
+    CYKSession other(grammar);
+    other.append("GGCAUAAGCC");
+    CHECK(other.accepted());
+    CHECK(other.accepted(2));
+    CHECK_FALSE(other.accepted(3));
+}
+
+TEST_CASE("Batched CYK", "[CYK]") {
+    const CNF rna = stemLoop();
+
+    const std::set<std::string> all = test::strings("AGUC", 5);
+    const std::vector<std::string> batch(all.begin(), all.end());
+
+    for (const unsigned int& threads : {1u, 4u}) {
+        const std::vector<bool> accepted = rna.CYK(batch, threads);
+
+        REQUIRE(accepted.size() == batch.size());
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            CHECK(accepted.at(i) == rna.CYK(batch.at(i)));
+        } // end for
+    } // end for
+
+    // an invalid string anywhere in the batch
+    std::vector<std::string> invalid = batch;
+    invalid.push_back("AGXU");
+    CHECK_THROWS_AS(rna.CYK(invalid, 2), std::invalid_argument);
+
+    CHECK(rna.CYK(std::vector<std::string>(), 2).empty());
+
+    // a scratch table is reused for shorter and longer strings
+    const CYKGrammar grammar(rna);
+    CYKMatrix matrix(grammar);
+    CHECK_FALSE(matrix.accepted());
+    matrix.parse("GGCAUAAGCC");
+    CHECK(matrix.accepted());
+    matrix.parse("GCA");
+    CHECK_FALSE(matrix.accepted());
+    matrix.parse("GGCAUAAGCC");
+    CHECK(matrix.accepted());
+}
+
+TEST_CASE("CYK derivation trees", "[CYK]") {
+    SECTION("RNA") {
+        const CNF rna = stemLoop();
+        const CYKGrammar grammar(rna);
+
+        for (const std::string& s : test::strings("AGUC", 5)) {
+            const CYKParse parse(grammar, s);
+
+            REQUIRE(parse.accepted() == rna.CYK(s));
+
+            if (!parse.accepted()) {
+                CHECK_THROWS_AS(parse.tree(), std::runtime_error);
+                continue;
+            } // end if
+
+            // the leaves spell the string, each node covers its children
+            const CYKTree tree = parse.tree();
+            std::string leaves(s.size(), ' ');
+
+            CHECK(tree.front().variable == 'p');
+            CHECK(tree.front().start == 1);
+            CHECK(tree.front().length == s.size());
+
+            for (const CYKNode& node : tree) {
+                if (node.left == -1) {
+                    REQUIRE(node.length == 1);
+                    leaves.at(node.start - 1) = node.terminal;
+                    continue;
+                } // end if
+
+                const CYKNode& left = tree.at(node.left);
+                const CYKNode& right = tree.at(node.right);
+
+                CHECK(left.start == node.start);
+                CHECK(right.start == node.start + left.length);
+                CHECK(node.length == left.length + right.length);
+                CHECK(grammar.heads(grammar.id(left.variable), grammar.id(right.variable)).first != NULL);
+            } // end for
+
+            CHECK(leaves == s);
+        } // end for
+
+        CHECK_THROWS_AS(CYKParse(grammar, "AXU"), std::invalid_argument);
+        CHECK_THROWS_AS(CYKParse(grammar, "AU").derivations(), std::runtime_error);
+    }
+
+    SECTION("Counting") {
+        // S --> SS | a has Catalan(n - 1) derivations of a^n
+        const std::set<char> terminals = {'a'};
+        const std::set<char> variables = {'S'};
+        const std::multimap<char, SymbolString> productions = {{'S', "SS"}, {'S', "a"}};
+        const CNF cnf(terminals, variables, productions, 'S');
+        const CYKGrammar grammar(cnf);
+
+        const unsigned long long catalan[] = {1, 1, 2, 5, 14, 42, 132, 429, 1430, 4862};
+
+        for (unsigned int n = 1; n <= 10; ++n) {
+            const CYKParse parse(grammar, std::string(n, 'a'), true);
+
+            CHECK(parse.derivations() == catalan[n - 1]);
+            CHECK(parse.tree().size() == 2 * n - 1);
+        } // end for
+
+        // saturates instead of overflowing
+        const CYKParse parse(grammar, std::string(60, 'a'), true);
+        CHECK(parse.derivations() == std::numeric_limits<unsigned long long>::max());
+    }
+
+    SECTION("Matching rules") {
+        const CNF rna = stemLoop();
+        const CYKGrammar grammar(rna);
+        const auto& rules = grammar.binaryRules();
+
+        for (const char& b : std::string("AGUC")) {
+            for (const char& c : std::string("AGUC")) {
+                const CYKWord* left = grammar.terminal(b);
+                const CYKWord* right = grammar.terminal(c);
+                std::vector<unsigned int> expected;
+                std::vector<unsigned int> found;
+
+                for (unsigned int r = 0; r < rules.size(); ++r) {
+                    const bool hasLeft = (left[rules[r].left / 64] >> (rules[r].left % 64)) & 1;
+                    const bool hasRight = (right[rules[r].right / 64] >> (rules[r].right % 64)) & 1;
+
+                    if (hasLeft && hasRight)
+                        expected.push_back(r);
+                } // end for
+
+                grammar.matches(left, right, found);
+                std::sort(found.begin(), found.end());
+
+                CHECK(found == expected);
+            } // end for
+        } // end for
+
+        // no derivations for a variable outside the set of a cell
+        const CYKParse parse(grammar, "GAAAC", true);
+
+        for (unsigned int a = 0; a < grammar.size(); ++a) {
+            const unsigned long long count = parse.derivations(a, 2, 3);
+            CHECK(parse.derives(a, 2, 3) == (count > 0));
+        } // end for
+    }
+}
+
+TEST_CASE("Weighted CYK", "[CYK]") {
+    SECTION("Epsilon and unit productions") {
+        // S --> A | b, A --> aA | epsilon
+        const std::set<char> terminals = {'a', 'b'};
+        const std::set<char> variables = {'S', 'A'};
+        const std::multimap<char, SymbolString> productions = {
+            {'S', "A"}, {'S', "b"}, {'A', "aA"}, {'A', ""}
+        };
+        const ProductionWeights weights = {
+            {{'S', "A"}, 0.5}, {{'S', "b"}, 0.5}, {{'A', "aA"}, 0.4}, {{'A', ""}, 0.6}
+        };
+
+        const CNF cnf(terminals, variables, productions, 'S', weights);
+        const CYKGrammar grammar(cnf);
+
+        CHECK(cnf.isWeighted());
+        CHECK_FALSE(stemLoop().isWeighted());
+
+        CHECK(std::exp(CYKScore(grammar, "b").viterbi()) == Approx(0.5));
+        CHECK(std::exp(CYKScore(grammar, "a").viterbi()) == Approx(0.5 * 0.4 * 0.6));
+        CHECK(std::exp(CYKScore(grammar, "aaa").viterbi()) == Approx(0.5 * 0.4 * 0.4 * 0.4 * 0.6));
+        CHECK(std::exp(CYKScore(grammar, "aaa").inside()) == Approx(0.5 * 0.4 * 0.4 * 0.4 * 0.6));
+        CHECK(CYKScore(grammar, "ab").viterbi() == -std::numeric_limits<double>::infinity());
+
+        CHECK_THROWS_AS(CNF(terminals, variables, productions, 'S', {{{'S', "b"}, 0}}), std::invalid_argument);
+
+        // a weight above 1 would let the cycle A --> aA | epsilon gain weight
+        CHECK_THROWS_AS(CNF(terminals, variables, productions, 'S', {{{'A', ""}, 2}}), std::invalid_argument);
+        CHECK_THROWS_AS(CNF(terminals, variables, productions, 'S', {{{'S', "A"}, 1.5}}), std::invalid_argument);
+        CHECK(CNF(terminals, variables, productions, 'S', {{{'S', "A"}, 1}}).isWeighted());
+    }
+
+    SECTION("Ambiguous grammar") {
+        // S --> SS | a, a^3 has two derivations
+        const std::set<char> terminals = {'a'};
+        const std::set<char> variables = {'S'};
+        const std::multimap<char, SymbolString> productions = {{'S', "SS"}, {'S', "a"}};
+        const ProductionWeights weights = {{{'S', "SS"}, 0.3}, {{'S', "a"}, 0.7}};
+
+        const CNF cnf(terminals, variables, productions, 'S', weights);
+        const CYKGrammar grammar(cnf);
+        const CYKScore score(grammar, "aaa");
+        const double one = 0.3 * 0.3 * 0.7 * 0.7 * 0.7;
+
+        CHECK(std::exp(score.viterbi()) == Approx(one));
+        CHECK(std::exp(score.inside()) == Approx(2 * one));
+        CHECK(score.tree().size() == 5);
+    }
+
+    SECTION("XML") {
+        const CNF rna = generateCNF(std::string(DATADIR) + "StemLoop.xml");
+        const CNF unweighted = stemLoop();
+        const CYKGrammar grammar(rna);
+
+        REQUIRE(rna.isWeighted());
+
+        for (const std::string& s : test::strings("AGUC", 5)) {
+            const CYKScore score(grammar, s);
+
+            CHECK(score.accepted() == unweighted.CYK(s));
+            CHECK(score.viterbi() <= score.inside());
+        } // end for
+
+        // a single derivation
+        const CYKScore loop(grammar, "GAAAC");
+        CHECK(std::exp(loop.viterbi()) == Approx(0.1 * 0.15 * 0.15 * 0.1));
+        CHECK(std::exp(loop.inside()) == Approx(0.1 * 0.15 * 0.15 * 0.1));
+
+        // two derivations, the longest stem is the best one
+        const CYKScore stem(grammar, "GCAGC");
+        CHECK(std::exp(stem.viterbi()) == Approx(0.2 * 0.1 * 0.1));
+        CHECK(std::exp(stem.inside()) == Approx(0.2 * 0.1 * 0.1 + 0.1 * 0.15 * 0.15 * 0.1));
+
+        const CYKTree tree = stem.tree();
+        CHECK(tree.front().variable == 'p');
+        CHECK(std::count_if(tree.begin(), tree.end(), [](const CYKNode& n) { return n.variable == 'p'; }) == 2);
+
+        CHECK_THROWS_AS(generateCNF(std::string(DATADIR) + "PDA.xml"), std::runtime_error);
+    }
+}
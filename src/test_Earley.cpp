@@ -0,0 +1,148 @@
+/* Test Earley
+ * Test the Earley recognizer against the CYK algorithm.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Catch.h"
+#include "CFG.h"
+#include "CNF.h"
+#include "Earley.h"
+#include "test_Helpers.h"
+#include <set>
+#include <map>
+#include <string>
+#include <stdexcept>
+
+namespace {
+
+// check the Earley recognizer against CNF::CYK on all (non-empty) strings
+struct EarleyCheck {
+    explicit EarleyCheck(const CFG& cfg)
+        : grammar(cfg),
+          cnf(cfg.getTerminals(), cfg.getVariables(), cfg.getProductions(), cfg.getStartsymbol()) {}
+
+    void operator()(const std::string& s) const {
+        CHECK(EarleyRecognizer(grammar, s).accepted() == cnf.CYK(s));
+    }
+
+    const EarleyGrammar grammar;
+    const CNF cnf;
+};
+
+} // end namespace
+
+TEST_CASE("Earley recognizer", "[Earley]") {
+    SECTION("Stem loop") {
+        const std::set<char> terminals = {'A', 'G', 'U', 'C'};
+        const std::set<char> variables = {'p', 'q'};
+        const std::multimap<char, SymbolString> productions = {
+            {'p', "AqU"}, {'p', "UqA"}, {'p', "CqG"}, {'p', "GqC"},
+            {'p', "ApU"}, {'p', "UpA"}, {'p', "CpG"}, {'p', "GpC"},
+            {'q', "A"}, {'q', "U"}, {'q', "G"}, {'q', "C"},
+            {'q', "Aq"}, {'q', "Uq"}, {'q', "Gq"}, {'q', "Cq"}
+        };
+
+        test::compare<EarleyCheck>(terminals, variables, productions, 'p', 6);
+
+        const EarleyGrammar grammar(CFG(terminals, variables, productions, 'p'));
+        CHECK(EarleyRecognizer(grammar, "GGAAAACC").accepted());
+        CHECK_FALSE(EarleyRecognizer(grammar, "").accepted());
+        CHECK_THROWS_AS(EarleyRecognizer(grammar, "GGTACC"), std::invalid_argument);
+    }
+
+    SECTION("Epsilon and unit productions") {
+        const std::set<char> terminals = {'a', 'b'};
+        const std::set<char> variables = {'A', 'B', 'C', 'S'};
+        const std::multimap<char, SymbolString> productions = {
+                                                            {'S', "A"},
+                                                            {'S', "B"},
+                                                            {'S', "CSC"},
+                                                            {'A', "aAa"},
+                                                            {'A', ""},
+                                                            {'B', "bBb"},
+                                                            {'B', ""},
+                                                            {'C', "ab"},
+                                                            {'C', "S"}
+                                                            };
+
+        test::compare<EarleyCheck>(terminals, variables, productions, 'S', 7);
+
+        // unlike a CNF, the empty string can be accepted
+        const EarleyGrammar grammar(CFG(terminals, variables, productions, 'S'));
+        CHECK(EarleyRecognizer(grammar, "").accepted());
+    }
+
+    SECTION("Ambiguous and left recursive") {
+        // S --> SS | aSb | ab | S+S
+        const std::set<char> terminals = {'a', 'b', '+'};
+        const std::set<char> variables = {'S'};
+        const std::multimap<char, SymbolString> productions = {
+                                                            {'S', "SS"},
+                                                            {'S', "aSb"},
+                                                            {'S', "ab"},
+                                                            {'S', "S+S"}
+                                                            };
+
+        test::compare<EarleyCheck>(terminals, variables, productions, 'S', 7);
+    }
+
+    SECTION("Right recursion takes linear time") {
+        // S --> aS | bS | a, with chains of completed items
+        const std::set<char> terminals = {'a', 'b'};
+        const std::set<char> variables = {'S', 'T'};
+        const std::multimap<char, SymbolString> productions = {
+                                                            {'S', "aS"},
+                                                            {'S', "bT"},
+                                                            {'S', "a"},
+                                                            {'T', "S"}
+                                                            };
+
+        test::compare<EarleyCheck>(terminals, variables, productions, 'S', 8);
+
+        const EarleyGrammar grammar(CFG(terminals, variables, productions, 'S'));
+
+        std::string s;
+        for (unsigned int i = 0; i < 2000; ++i) {
+            s += (i % 3 == 0) ? 'b' : 'a';
+        } // end for
+
+        const EarleyRecognizer short_recognizer(grammar, s + 'a');
+        const EarleyRecognizer long_recognizer(grammar, s + s + 'a');
+
+        CHECK(short_recognizer.accepted());
+        CHECK(long_recognizer.accepted());
+        CHECK_FALSE(EarleyRecognizer(grammar, s + 'b').accepted());
+
+        // twice as long, about twice as much items
+        CHECK(long_recognizer.items() <= 2 * short_recognizer.items() + 20);
+        CHECK(short_recognizer.first(0) == 0);
+        CHECK(short_recognizer.first(short_recognizer.length() + 1) == short_recognizer.items());
+    }
+
+    SECTION("Unit cycles") {
+        // S --> T | a, T --> S | Tb
+        const std::set<char> terminals = {'a', 'b'};
+        const std::set<char> variables = {'S', 'T'};
+        const std::multimap<char, SymbolString> productions = {
+                                                            {'S', "T"},
+                                                            {'S', "a"},
+                                                            {'T', "S"},
+                                                            {'T', "Tb"}
+                                                            };
+
+        test::compare<EarleyCheck>(terminals, variables, productions, 'S', 8);
+    }
+}
@@ -0,0 +1,197 @@
+/* Test GLL
+ * Test the GLL parser against the Earley recognizer.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Catch.h"
+#include "CFG.h"
+#include "Earley.h"
+#include "GLL.h"
+#include "test_Helpers.h"
+#include <set>
+#include <map>
+#include <string>
+#include <stdexcept>
+
+namespace {
+
+// check the GLL parser against the Earley recognizer
+struct GLLCheck {
+    explicit GLLCheck(const CFG& cfg) : grammar(cfg), start(cfg.getStartsymbol()) {}
+
+    void operator()(const std::string& s) const {
+        const GLLParse parse(grammar, s);
+        CHECK(parse.accepted() == EarleyRecognizer(grammar, s).accepted());
+
+        if (parse.accepted()) {
+            const GLLParse::Node& root = parse.node(parse.root());
+            CHECK(start == root.label);
+            CHECK(0 == root.left);
+            CHECK(s.size() == root.right);
+        } // end if
+    }
+
+    const EarleyGrammar grammar;
+    const char start;
+};
+
+// the amount of parse trees below a node of the forest
+unsigned long long trees(const GLLParse& parse, const int& k) {
+    if (k == -1)
+        return 1;
+
+    const GLLParse::Node& node = parse.node(k);
+
+    if (node.packed.empty())
+        return 1;
+
+    unsigned long long result = 0;
+    for (const GLLParse::Packed& p : node.packed) {
+        result += trees(parse, p.left) * trees(parse, p.right);
+    } // end for
+
+    return result;
+}
+
+} // end namespace
+
+TEST_CASE("GLL parser", "[GLL]") {
+    SECTION("Stem loop") {
+        const std::set<char> terminals = {'A', 'G', 'U', 'C'};
+        const std::set<char> variables = {'p', 'q'};
+        const std::multimap<char, SymbolString> productions = {
+            {'p', "AqU"}, {'p', "UqA"}, {'p', "CqG"}, {'p', "GqC"},
+            {'p', "ApU"}, {'p', "UpA"}, {'p', "CpG"}, {'p', "GpC"},
+            {'q', "A"}, {'q', "U"}, {'q', "G"}, {'q', "C"},
+            {'q', "Aq"}, {'q', "Uq"}, {'q', "Gq"}, {'q', "Cq"}
+        };
+
+        test::compare<GLLCheck>(terminals, variables, productions, 'p', 6, true);
+
+        const EarleyGrammar grammar(CFG(terminals, variables, productions, 'p'));
+
+        // GG|AAAA|CC and G|GAAAAC|C
+        const GLLParse parse(grammar, "GGAAAACC");
+        REQUIRE(parse.accepted());
+        CHECK(2 == trees(parse, parse.root()));
+
+        CHECK_FALSE(GLLParse(grammar, "GGAAAAG").accepted());
+        CHECK(GLLParse(grammar, "GGAAAAG").toDot().empty());
+        CHECK_THROWS_AS(GLLParse(grammar, "GGTACC"), std::invalid_argument);
+    }
+
+    SECTION("Epsilon and unit productions") {
+        const std::set<char> terminals = {'a', 'b'};
+        const std::set<char> variables = {'A', 'B', 'C', 'S'};
+        const std::multimap<char, SymbolString> productions = {
+                                                            {'S', "A"},
+                                                            {'S', "B"},
+                                                            {'S', "CSC"},
+                                                            {'A', "aAa"},
+                                                            {'A', ""},
+                                                            {'B', "bBb"},
+                                                            {'B', ""},
+                                                            {'C', "ab"},
+                                                            {'C', "S"}
+                                                            };
+
+        test::compare<GLLCheck>(terminals, variables, productions, 'S', 7, true);
+    }
+
+    SECTION("Ambiguous and left recursive") {
+        // S --> SS | aSb | ab | S+S
+        const std::set<char> terminals = {'a', 'b', '+'};
+        const std::set<char> variables = {'S'};
+        const std::multimap<char, SymbolString> productions = {
+                                                            {'S', "SS"},
+                                                            {'S', "aSb"},
+                                                            {'S', "ab"},
+                                                            {'S', "S+S"}
+                                                            };
+
+        test::compare<GLLCheck>(terminals, variables, productions, 'S', 7, true);
+
+        const EarleyGrammar grammar(CFG(terminals, variables, productions, 'S'));
+
+        // the Catalan numbers: 1, 1, 2, 5, ... ways to split ab...ab
+        const unsigned long long catalan[] = {1, 1, 2, 5, 14, 42, 132, 429};
+        std::string s;
+
+        for (unsigned int k = 1; k < 8; ++k) {
+            s += "ab";
+
+            const GLLParse parse(grammar, s);
+            REQUIRE(parse.accepted());
+            CHECK(catalan[k - 1] == trees(parse, parse.root()));
+        } // end for
+    }
+
+    SECTION("Forest stays cubic") {
+        // S --> SS | a, exponentially many trees
+        const std::set<char> terminals = {'a'};
+        const std::set<char> variables = {'S'};
+        const std::multimap<char, SymbolString> productions = {
+                                                            {'S', "SS"},
+                                                            {'S', "a"}
+                                                            };
+
+        const EarleyGrammar grammar(CFG(terminals, variables, productions, 'S'));
+
+        for (const unsigned int& n : {10u, 20u, 40u}) {
+            const GLLParse parse(grammar, std::string(n, 'a'));
+            REQUIRE(parse.accepted());
+
+            // a node (S, i, j) for each 0 <= i < j <= n with a packed node
+            // for each split i < k < j, and the nodes (a, i, i + 1) and
+            // (S', 0, j) with one packed node each
+            const std::size_t nodes = n * (n + 1) / 2 + 2 * n;
+            const std::size_t packed = (n + 1) * n * (n - 1) / 6 + 2 * n;
+            CHECK(nodes == parse.nodes());
+            CHECK(packed == parse.packedNodes());
+        } // end for
+    }
+
+    SECTION("Unit cycles") {
+        // S --> T | a, T --> S | Tb
+        const std::set<char> terminals = {'a', 'b'};
+        const std::set<char> variables = {'S', 'T'};
+        const std::multimap<char, SymbolString> productions = {
+                                                            {'S', "T"},
+                                                            {'S', "a"},
+                                                            {'T', "S"},
+                                                            {'T', "Tb"}
+                                                            };
+
+        test::compare<GLLCheck>(terminals, variables, productions, 'S', 8, true);
+    }
+
+    SECTION("Dot format") {
+        const std::set<char> terminals = {'a', 'b'};
+        const std::set<char> variables = {'S'};
+        const std::multimap<char, SymbolString> productions = {
+                                                            {'S', "aSb"},
+                                                            {'S', ""}
+                                                            };
+
+        const EarleyGrammar grammar(CFG(terminals, variables, productions, 'S'));
+        const std::string dot = GLLParse(grammar, "ab").toDot();
+
+        CHECK(0 == dot.find("digraph SPPF {"));
+        CHECK(std::string::npos != dot.find("S ::= aS.b"));
+        CHECK(std::string::npos != dot.find("&epsilon;, 1, 1"));
+        CHECK(std::string::npos != dot.find("label=\"S, 0, 2\""));
+    }
+}
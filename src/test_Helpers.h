@@ -0,0 +1,100 @@
+/* Test helpers
+ * Fixtures shared by the tests of the recognizers and parsers.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_TEST_HELPERS_H
+#define H_TEST_HELPERS_H
+
+#include "Catch.h"
+#include "CFG.h"
+#include <set>
+#include <map>
+#include <string>
+
+namespace test {
+
+/**
+ * @brief All the strings over the alphabet with a length from 1 up to the passed length.
+ *
+ * @param alphabet The characters of the strings.
+ * @param length The maximal length of the strings.
+ * @param empty Whether the empty string is included.
+ *
+ * @return The strings.
+ */
+inline std::set<std::string> strings(
+    const std::string& alphabet,
+    const unsigned int& length,
+    const bool& empty = false
+    ) {
+    std::set<std::string> result;
+    std::set<std::string> last = {""};
+
+    if (empty)
+        result.insert("");
+
+    for (unsigned int l = 1; l <= length; ++l) {
+        std::set<std::string> next;
+
+        for (const std::string& s : last) {
+            for (const char& c : alphabet) {
+                next.insert(s + c);
+            } // end for
+        } // end for
+
+        result.insert(next.begin(), next.end());
+        last = next;
+    } // end for
+
+    return result;
+}
+
+/**
+ * @brief Run a check on all the strings over the terminals of a CFG.
+ *
+ * The Check is constructed once from the CFG and then called with each string.
+ *
+ * @param terminals The terminals of the CFG.
+ * @param variables The variables of the CFG.
+ * @param productions The production rules of the CFG.
+ * @param start The start symbol of the CFG.
+ * @param length The maximal length of the strings.
+ * @param empty Whether the empty string is checked as well.
+ */
+template <typename Check>
+void compare(
+    const std::set<char>& terminals,
+    const std::set<char>& variables,
+    const std::multimap<char, SymbolString>& productions,
+    const char& start,
+    const unsigned int& length,
+    const bool& empty = false
+    ) {
+    const Check check(CFG(terminals, variables, productions, start));
+
+    const std::string alphabet(terminals.begin(), terminals.end());
+
+    for (const std::string& s : strings(alphabet, length, empty)) {
+        INFO(s);
+        check(s);
+    } // end for
+}
+
+} // end namespace test
+
+#endif // H_TEST_HELPERS_H
@@ -0,0 +1,302 @@
+/* Test IndexedGrammar
+ * Test the grammar with integer symbols and its conversion to CNF.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Catch.h"
+#include "CNF.h"
+#include "CYK.h"
+#include "IndexedGrammar.h"
+#include <set>
+#include <map>
+#include <string>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("Indexed grammar", "[IndexedGrammar]") {
+    SECTION("Symbols") {
+        IndexedGrammar g;
+        g.addTerminal('a');
+
+        const Symbol s = g.addVariable('S');
+        const Symbol t = g.addVariable();
+
+        CHECK(IndexedGrammar::isTerminal(IndexedGrammar::terminal('a')));
+        CHECK_FALSE(IndexedGrammar::isTerminal(s));
+        CHECK(IndexedGrammar::toIndex(t) == 1);
+        CHECK(g.variables() == 2);
+        CHECK(g.name(s) == 'S');
+        CHECK(g.name(t) == 0);
+        CHECK_FALSE(g.hasStart());
+
+        g.addProduction(s, {IndexedGrammar::terminal('a'), t});
+        CHECK(g.productions() == 1);
+        CHECK(g.bodySize(0) == 2);
+        CHECK(g.body(0)[1] == t);
+
+        CHECK_THROWS_AS(g.addProduction(IndexedGrammar::terminal('a'), {}), std::invalid_argument);
+        CHECK_THROWS_AS(g.addProduction(s, {IndexedGrammar::terminal('b')}), std::invalid_argument);
+        CHECK_THROWS_AS(g.addProduction(s, {IndexedGrammar::variable(2)}), std::invalid_argument);
+        CHECK_THROWS_AS(g.addProduction(s, {}, 0.5), std::invalid_argument);
+        CHECK_THROWS_AS(g.setStart(IndexedGrammar::variable(5)), std::invalid_argument);
+    }
+
+    SECTION("Conversion of a CFG") {
+        // the same grammar as in the CYK tests, with epsilon and unit rules
+        const std::set<char> terminals = {'a', 'b'};
+        const std::set<char> variables = {'A', 'B', 'C', 'S'};
+        const std::multimap<char, SymbolString> productions = {
+                                                            {'S', "A"},
+                                                            {'S', "B"},
+                                                            {'A', "aAa"},
+                                                            {'A', ""},
+                                                            {'B', "bBb"},
+                                                            {'B', ""},
+                                                            {'C', "aCa"},
+                                                            {'C', "bCb"},
+                                                            {'C', "S"}
+                                                            };
+        const CNF cnf(terminals, variables, productions, 'S');
+
+        IndexedGrammar g(CFG(terminals, variables, productions, 'S'));
+        g.toCNF();
+
+        REQUIRE(g.isCNF());
+        const CYKGrammar grammar(g);
+
+        std::set<std::string> strings = {""};
+        for (unsigned int l = 1; l <= 8; ++l) {
+            std::set<std::string> next;
+
+            for (const std::string& s : strings) {
+                next.insert(s + 'a');
+                next.insert(s + 'b');
+            } // end for
+
+            strings = next;
+
+            for (const std::string& s : strings) {
+                CHECK(CYKMatrix(grammar, s).accepted() == cnf.CYK(s));
+            } // end for
+        } // end for
+
+        // leaving out subsets of nullable symbols gives the same language
+        IndexedGrammar h(CFG(terminals, variables, productions, 'S'));
+        h.toCNF(EPSILON_SUBSETS);
+
+        REQUIRE(h.isCNF());
+        const CYKGrammar subsets(h);
+
+        for (const std::string& s : strings) {
+            CHECK(CYKMatrix(subsets, s).accepted() == cnf.CYK(s));
+        } // end for
+
+        // a CNF is already in Chomsky Normal Form
+        CHECK(IndexedGrammar(cnf).isCNF());
+        CHECK_THROWS_AS(CYKGrammar(IndexedGrammar(CFG(terminals, variables, productions, 'S'))), std::invalid_argument);
+    }
+
+    SECTION("Long nullable bodies") {
+        // S --> BBB...B a (30 times B), B --> b | epsilon
+        IndexedGrammar g;
+        g.addTerminal('a');
+        g.addTerminal('b');
+        const Symbol s = g.addVariable('S');
+        const Symbol b = g.addVariable('B');
+
+        std::vector<Symbol> body(30, b);
+        body.push_back(IndexedGrammar::terminal('a'));
+        g.addProduction(s, body);
+        g.addProduction(b, {});
+        g.addProduction(b, {IndexedGrammar::terminal('b')});
+        g.setStart(s);
+
+        // quadratic in the length of the body
+        g.toCNF();
+        CHECK(g.productions() <= 2 * 31 * 32);
+
+        const CYKGrammar grammar(g);
+        CHECK(CYKMatrix(grammar, "a").accepted());
+        CHECK(CYKMatrix(grammar, std::string(30, 'b') + 'a').accepted());
+        CHECK_FALSE(CYKMatrix(grammar, std::string(31, 'b') + 'a').accepted());
+        CHECK_FALSE(CYKMatrix(grammar, "ab").accepted());
+    }
+
+    SECTION("Unit cycles") {
+        // S --> A, A --> S | a: CFG::units() doesn't allow this
+        IndexedGrammar g;
+        g.addTerminal('a');
+        const Symbol s = g.addVariable('S');
+        const Symbol a = g.addVariable('A');
+        g.addProduction(s, {a});
+        g.addProduction(a, {s});
+        g.addProduction(a, {IndexedGrammar::terminal('a')});
+        g.setStart(s);
+
+        g.toCNF();
+        // S --> a, A is not reachable anymore
+        REQUIRE(g.productions() == 1);
+
+        const CYKGrammar grammar(g);
+        CHECK(CYKMatrix(grammar, "a").accepted());
+        CHECK_FALSE(CYKMatrix(grammar, "aa").accepted());
+
+        // the same for a CNF, its clean up collapses the cycle
+        const std::multimap<char, SymbolString> productions = {
+                                                            {'S', "A"},
+                                                            {'A', "S"},
+                                                            {'A', "a"}
+                                                            };
+        const CNF cnf({'a'}, {'S', 'A'}, productions, 'S');
+        CHECK(cnf.CYK("a"));
+        CHECK_FALSE(cnf.CYK("aa"));
+    }
+
+    SECTION("Many variables") {
+        // X(i) --> a X(i+1) b | c, so a^k c b^k with k < n
+        const unsigned int n = 20000;
+
+        IndexedGrammar g;
+        g.addTerminal('a');
+        g.addTerminal('b');
+        g.addTerminal('c');
+
+        for (unsigned int i = 0; i < n; ++i) {
+            g.addVariable();
+        } // end for
+
+        for (unsigned int i = 0; i < n; ++i) {
+            const Symbol x = IndexedGrammar::variable(i);
+
+            if (i + 1 < n)
+                g.addProduction(x, {IndexedGrammar::terminal('a'), IndexedGrammar::variable(i + 1), IndexedGrammar::terminal('b')});
+
+            g.addProduction(x, {IndexedGrammar::terminal('c')});
+        } // end for
+
+        g.setStart(IndexedGrammar::variable(0));
+        g.toCNF();
+
+        REQUIRE(g.isCNF());
+        CHECK(g.variables() > n);
+
+        const CYKGrammar grammar(g);
+        CHECK(grammar.size() > n);
+
+        CHECK(CYKMatrix(grammar, "c").accepted());
+        CHECK(CYKMatrix(grammar, "aaaacbbbb").accepted());
+        CHECK_FALSE(CYKMatrix(grammar, "aaaacbbb").accepted());
+    }
+
+    SECTION("Shared prefixes") {
+        // S --> abcd | abce | abcdS, all bodies start with abc
+        const std::set<char> terminals = {'a', 'b', 'c', 'd', 'e'};
+        const std::set<char> variables = {'S'};
+        const std::multimap<char, SymbolString> productions = {
+                                                            {'S', "abcd"},
+                                                            {'S', "abce"},
+                                                            {'S', "abcdS"}
+                                                            };
+
+        IndexedGrammar fresh(CFG(terminals, variables, productions, 'S'));
+        fresh.toCNF(EPSILON_BINARIZED, BINARIZE_FRESH);
+        IndexedGrammar shared(CFG(terminals, variables, productions, 'S'));
+        shared.toCNF(EPSILON_BINARIZED, BINARIZE_SHARED);
+
+        // 5 rules for the terminals, then 2 + 2 + 3 prefixes for ab, abc and
+        // abcd, and the 3 rules of S
+        CHECK(fresh.productions() == 5 + 7 + 3);
+        CHECK(shared.productions() == 5 + 3 + 3);
+
+        const CNF cnfFresh(terminals, variables, productions, 'S');
+        const CNF cnfShared(terminals, variables, productions, 'S', ProductionWeights(), BINARIZE_SHARED);
+        CHECK(cnfFresh.getProductions().size() == fresh.productions());
+        CHECK(cnfShared.getProductions().size() == shared.productions());
+
+        const CYKGrammar freshGrammar(fresh), sharedGrammar(shared);
+        const std::vector<std::string> strings = {
+            "abcd", "abce", "abcdabce", "abcdabcdabcd", "abc", "abcdabc", "abced", "abcdd"
+        };
+
+        for (const std::string& s : strings) {
+            const bool accepted = cnfFresh.CYK(s);
+            CHECK(cnfShared.CYK(s) == accepted);
+            CHECK(CYKMatrix(freshGrammar, s).accepted() == accepted);
+            CHECK(CYKMatrix(sharedGrammar, s).accepted() == accepted);
+        } // end for
+    }
+
+    SECTION("Cleaning up a CFG") {
+        // S --> A | a, A --> S: the CFG is left as it was
+        const std::set<char> terminals = {'a'};
+        const std::set<char> variables = {'A', 'S'};
+        const std::multimap<char, SymbolString> productions = {{'S', "A"}, {'S', "a"}, {'A', "S"}};
+
+        CFG cfg(terminals, variables, productions, 'S');
+        CHECK_THROWS_AS(cfg.eleminateUnitProductions(UNITS_ACYCLIC), std::runtime_error);
+        CHECK(cfg.getProductions() == productions);
+
+        IndexedGrammar g(cfg);
+        CHECK_THROWS_AS(g.eleminateUnitProductions(UNITS_ACYCLIC), std::runtime_error);
+        CHECK(g.productions() == 3);
+
+        // the stages of CFG::cleanUp() are those of the IndexedGrammar
+        cfg.cleanUp();
+        const std::multimap<char, SymbolString> cleaned = {{'S', "a"}};
+        CHECK(cfg.getProductions() == cleaned);
+        REQUIRE(4 == cfg.getStats().stages.size());
+        CHECK("useless" == cfg.getStats().stages.back().stage);
+        CHECK(1 == cfg.getStats().stages.back().variables);
+    }
+
+    SECTION("Only the variables of the CNF count") {
+        // S --> SS | t for all other characters t: the terminals don't need
+        // variables of their own, so this fits even though there are 254
+        // terminals
+        std::set<char> terminals;
+        std::multimap<char, SymbolString> productions = {{'S', "SS"}};
+
+        for (unsigned int c = 1; c < 256; ++c) {
+            if (static_cast<char>(c) == 'S')
+                continue;
+
+            terminals.insert(static_cast<char>(c));
+            productions.insert(std::pair<char, SymbolString>('S', SymbolString(1, static_cast<char>(c))));
+        } // end for
+
+        const CNF cnf(terminals, {'S'}, productions, 'S');
+        CHECK(cnf.getVariables().size() == 1);
+        CHECK(cnf.CYK("ab"));
+        CHECK(cnf.CYK("xyz", CYK_MATRIX));
+    }
+
+    SECTION("Too many variables for a CNF") {
+        // every body of length 3 needs a new variable
+        const std::set<char> terminals = {'a'};
+        const std::set<char> variables = {'S'};
+        std::multimap<char, SymbolString> productions;
+
+        for (unsigned int i = 0; i < 300; ++i) {
+            productions.insert(std::pair<char, SymbolString>('S', std::string(3 + i, 'a')));
+        } // end for
+
+        CHECK_THROWS_AS(CNF(terminals, variables, productions, 'S'), std::runtime_error);
+
+        IndexedGrammar g(CFG(terminals, variables, productions, 'S'));
+        g.toCNF();
+        CHECK(CYKMatrix(CYKGrammar(g), std::string(10, 'a')).accepted());
+    }
+}
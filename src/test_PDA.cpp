@@ -55,6 +55,63 @@ TEST_CASE("Stack Operation","[PDA]"){
 
 }
 
+TEST_CASE("Persistent stack","[PDA]"){
+	PDAState Q("Q", false);
+	PDAState P("P", false);
+
+	std::stack<char> stack;
+	stack.push(9);
+	stack.push('a');
+
+	PDAStackArena arena;
+	PDAStack start(arena, stack);
+	CHECK(start.size() == 2);
+	CHECK(start.top() == 'a');
+	CHECK(arena.size() == 2);
+
+	// two branches from the same stack
+	std::vector<char> pushVector = {'b', 'c'};
+	PDATransition t1(&Q, &P, '0', 'a', POPPUSH, pushVector);
+	PDATransition t2(&Q, &P, '0', 'a', POP);
+
+	PDAStack first = start;
+	t1.stackOperation(first);
+	PDAStack second = start;
+	t2.stackOperation(second);
+
+	CHECK(first.size() == 3);
+	CHECK(first.top() == 'c');
+	CHECK(second.size() == 1);
+	CHECK(second.top() == 9);
+
+	// the branches don't change each other, only the pushed cells are new
+	CHECK(start.size() == 2);
+	CHECK(start.top() == 'a');
+	CHECK(arena.size() == 4);
+
+	std::stack<char> firstStack = first.toStack();
+	std::stack<char> expected = stack;
+	expected.pop();
+	expected.push('b');
+	expected.push('c');
+	CHECK(firstStack == expected);
+
+	first.pop();
+	first.pop();
+	CHECK(first.top() == 9);
+	CHECK(first.toStack() == second.toStack());
+
+	// equal stacks share their cells
+	CHECK(first.cell() == second.cell());
+	PDAStack again = start;
+	t1.stackOperation(again);
+	CHECK(arena.size() == 4);
+
+	PDAStack empty(arena);
+	CHECK(empty.empty() == true);
+	CHECK_THROWS(t2.stackOperation(empty));
+}
+
 TEST_CASE("construction", "[PDA]"){
 	std::set<char> alphabet;
 	std::set<char> stackAlphabet;
@@ -424,3 +481,230 @@ TEST_CASE("CFGPDA 7","[PDA]"){
 
 
 
+
+TEST_CASE("Transition index", "[PDA]"){
+	PDAState Q("Q");
+	PDAState R("R", true);
+
+	PDATransition t1(&Q, &R, '1', 9, PUSH, '1');
+	PDATransition t2(&R, &R, '0', '1', POP);
+
+	std::set<char> alphabet = {'0', '1'};
+	std::set<char> stackAlphabet = {'0', '1'};
+
+	PDA pda(alphabet, stackAlphabet, STATE);
+	pda.addState(Q, true);
+	pda.addState(R);
+	pda.addTransition(t1);
+
+	CHECK(pda.process("1") == true);
+	CHECK(pda.process("10") == false);
+
+	// the index is built again after adding a transition
+	pda.addTransition(t2);
+	CHECK(pda.process("10") == true);
+	CHECK(pda.process("100") == false);
+
+	// a copy uses its own index
+	PDA copy = pda;
+	CHECK(copy.process("10") == true);
+	CHECK(copy.process("11") == false);
+}
+
+TEST_CASE("ID input position", "[PDA]"){
+	PDAState Q("Q");
+	PDAState R("R", true);
+
+	std::stack<char> stack;
+	stack.push(9);
+
+	PDAStackArena arena;
+	PDAStack start(arena, stack);
+
+	const std::string input = "101";
+	PDAID id(input, 0, &Q, start);
+	CHECK(id.getPosition() == 0);
+	CHECK(id.getRemaining() == 3);
+	CHECK(id.getInput() == "101");
+	CHECK(id.isAccepted(STATE) == false);
+
+	id.step(2, &R, start);
+	CHECK(id.getRemaining() == 1);
+	CHECK(id.getInput() == "1");
+	CHECK(id.isAccepted(STATE) == false);
+
+	id.step(3, &R, start);
+	CHECK(id.getRemaining() == 0);
+	CHECK(id.isAccepted(STATE) == true);
+	CHECK(id.isAccepted(STACK) == true);
+}
+
+TEST_CASE("Duplicate IDs", "[PDA]"){
+	PDAState Q("Q");
+	PDAState A("A");
+	PDAState B("B");
+	PDAState R("R");
+	PDAState S("S", true);
+
+	// two epsilon paths from Q to R, and an epsilon loop on R
+	PDATransition t1(&Q, &A, 0, 9, STAY);
+	PDATransition t2(&Q, &B, 0, 9, STAY);
+	PDATransition t3(&A, &R, 0, 9, STAY);
+	PDATransition t4(&B, &R, 0, 9, STAY);
+	PDATransition t5(&R, &R, 0, 9, STAY);
+	PDATransition t6(&R, &S, '1', 9, STAY);
+
+	std::set<char> alphabet = {'0', '1'};
+	std::set<char> stackAlphabet = {'0', '1'};
+
+	PDA pda(alphabet, stackAlphabet, STATE);
+	pda.addState(Q, true);
+	pda.addState(A);
+	pda.addState(B);
+	pda.addState(R);
+	pda.addState(S);
+	pda.addTransition(t1);
+	pda.addTransition(t2);
+	pda.addTransition(t3);
+	pda.addTransition(t4);
+	pda.addTransition(t5);
+	pda.addTransition(t6);
+
+	PDAStats stats;
+	CHECK(pda.process("1", stats) == true);
+
+	// the loop on R doesn't go on forever
+	CHECK(pda.process("0", stats) == false);
+	CHECK(stats.ids == 5);
+	CHECK(stats.duplicates == 2);
+	CHECK(stats.cut == 0);
+	CHECK(stats.cells == 1);
+
+	// a PDA based upon a CFG
+	const std::set<char> terminals = {'a', 'b'};
+	const std::set<char> variables = {'S'};
+	const std::multimap<char, SymbolString> productions = {
+		{'S', "aSb"},
+		{'S', "SS"},
+		{'S', ""}
+	};
+	PDA cfgPDA(CFG(terminals, variables, productions, 'S'));
+
+	CHECK(cfgPDA.process("aabbab", stats) == true);
+	CHECK(cfgPDA.process("aabbba", stats) == false);
+	CHECK(stats.duplicates > 0);
+	CHECK(stats.ids > stats.duplicates + stats.cut);
+}
+
+TEST_CASE("Saturation", "[PDA]"){
+	// all strings over the alphabet up to a length
+	auto strings = [](const std::string& alphabet, const unsigned int& length){
+		std::vector<std::string> all(1, "");
+		for(unsigned int i = 0; i < all.size(); i++){
+			if(all[i].size() < length){
+				for(auto c : alphabet){
+					all.push_back(all[i] + c);
+				}
+			}
+		}
+		return all;
+	};
+
+	SECTION("same as the search"){
+		PDAState Q("Q");
+		PDAState R("R");
+		PDAState S("S", true);
+
+		PDATransition t11(&Q, &R, '1', 9, PUSH, '1');
+		PDATransition t12(&Q, &R, '0', 9, PUSH, '0');
+		PDATransition t21(&R, &S, '1', '0', POP);
+		PDATransition t22(&R, &S, '0', '1', POP);
+		PDATransition t31(&S, &R, '1', 9, PUSH, '1');
+		PDATransition t32(&S, &R, '0', 9, PUSH, '0');
+
+		std::set<char> alphabet = {'0', '1'};
+		std::set<char> stackAlphabet = {'0', '1'};
+
+		PDA pda(alphabet, stackAlphabet, STATE);
+		pda.addState(Q, true);
+		pda.addState(R);
+		pda.addState(S);
+		pda.addTransition(t11);
+		pda.addTransition(t12);
+		pda.addTransition(t21);
+		pda.addTransition(t22);
+		pda.addTransition(t31);
+		pda.addTransition(t32);
+
+		PDAState P("P", true);
+		PDATransition t41(&P, &P, 'e', 'Z', POP);
+		PDATransition t42(&P, &P, 'i', 'Z', PUSH, 'Z');
+		PDATransition t43(&P, &P, 'i', 9, PUSH, 'Z');
+
+		PDA stack({'e', 'i'}, {'Z'}, STACK);
+		stack.addState(P, true);
+		stack.addTransition(t41);
+		stack.addTransition(t42);
+		stack.addTransition(t43);
+
+		const std::set<char> terminals = {'a', 'b'};
+		const std::set<char> variables = {'S', 'A'};
+		const std::multimap<char, SymbolString> productions = {
+			{'S', "aSb"},
+			{'S', "SS"},
+			{'S', "A"},
+			{'A', "ab"}
+		};
+		PDA cfgPDA(CFG(terminals, variables, productions, 'S'));
+
+		for(const std::string& s : strings("01", 8)){
+			CHECK(pda.process(s, PDA_SEARCH) == pda.process(s, PDA_SATURATION));
+		}
+		for(const std::string& s : strings("ei", 8)){
+			CHECK(stack.process(s, PDA_SEARCH) == stack.process(s, PDA_SATURATION));
+		}
+		for(const std::string& s : strings("ab", 8)){
+			CHECK(cfgPDA.process(s, PDA_SEARCH) == cfgPDA.process(s, PDA_SATURATION));
+		}
+
+		CHECK(cfgPDA.process("aabbab", PDA_SATURATION) == true);
+		CHECK(cfgPDA.process("aabbba", PDA_SATURATION) == false);
+	}
+
+	SECTION("the PDA of the GUI"){
+		PDA rna(std::string(DATADIR) + "PDARNA1.xml");
+
+		for(const std::string& s : strings("AUGC", 5)){
+			CHECK(rna.process(s, PDA_SEARCH) == rna.process(s, PDA_SATURATION));
+		}
+		CHECK(rna.process("GGAAAACC", PDA_SEARCH) == rna.process("GGAAAACC", PDA_SATURATION));
+		CHECK(rna.process("CCUGCAAAAAGCAGG", PDA_SEARCH) == rna.process("CCUGCAAAAAGCAGG", PDA_SATURATION));
+	}
+
+	SECTION("no stack bound"){
+		// the search throws away the ID's with too many B's on the stack
+		const std::set<char> terminals = {'a'};
+		const std::set<char> variables = {'S', 'B'};
+		const std::multimap<char, SymbolString> productions = {
+			{'S', "BBBBBBBBa"},
+			{'B', "a"},
+			{'B', ""}
+		};
+		PDA pda(CFG(terminals, variables, productions, 'S'));
+
+		CHECK(pda.process("a", PDA_SATURATION) == true);
+		CHECK(pda.process("aaaaa", PDA_SATURATION) == true);
+		CHECK(pda.process("aaaaaaaaa", PDA_SATURATION) == true);
+		CHECK(pda.process("aaaaaaaaaa", PDA_SATURATION) == false);
+		CHECK(pda.process("", PDA_SATURATION) == false);
+	}
+
+	SECTION("throws"){
+		PDA pda({'a'}, {'a'}, STATE);
+		CHECK_THROWS_AS(pda.process("a", PDA_SATURATION), std::runtime_error);
+
+		PDAState Q("Q");
+		pda.addState(Q, true);
+		CHECK_THROWS_AS(pda.process("b", PDA_SATURATION), std::runtime_error);
+	}
+}
@@ -0,0 +1,121 @@
+/* Test RecognizerGenerator
+ * Test the recognizer generated for the stem loop grammar at build time
+ * against the CYK engines.
+ *
+ * Copyright (C) 2014
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Catch.h"
+#include "CNF.h"
+#include "CYK.h"
+#include "RecognizerGenerator.h"
+#include "StemLoopRecognizer.h"
+#include <algorithm>
+#include <set>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST_CASE("Generated recognizers", "[RecognizerGenerator]") {
+    const CNF cnf = generateCNF(std::string(DATADIR) + "StemLoop.xml");
+
+    SECTION("Stem loop tables") {
+        const CYKGrammar grammar(cnf);
+        const std::vector<CYKGrammar::BinaryRule>& rules = grammar.binaryRules();
+
+        CHECK(grammar.size() == StemLoop::VARIABLES);
+        CHECK(1 == StemLoop::WORDS);
+        CHECK(StemLoop::HAS_START);
+        CHECK(grammar.start() == StemLoop::START);
+        CHECK(rules.size() == StemLoop::BINARY_RULE_COUNT);
+        CHECK(4 == StemLoop::TERMINAL_COUNT);
+        CHECK(8 == StemLoop::TERMINAL_RULE_COUNT);
+
+        for (std::size_t r = 0; r < StemLoop::BINARY_RULE_COUNT; ++r) {
+            const StemLoop::BinaryRule& rule = StemLoop::BINARY_RULES[r];
+            const bool found = std::any_of(rules.begin(), rules.end(), [&](const CYKGrammar::BinaryRule& x) {
+                return x.head == rule.head && x.left == rule.left && x.right == rule.right;
+            });
+            CHECK(found);
+
+            // the unrolled checks give the same as the table
+            StemLoop::Table table(2);
+            table.add(rule.left, 0, 1);
+            table.add(rule.right, 1, 2);
+            CHECK(StemLoop::combine(table, 0, 2).has(rule.head));
+        } // end for
+
+        for (std::size_t r = 0; r < StemLoop::TERMINAL_RULE_COUNT; ++r) {
+            const StemLoop::TerminalRule& rule = StemLoop::TERMINAL_RULES[r];
+            CHECK(0 != (*grammar.terminal(rule.terminal) & (1ULL << rule.head)));
+            CHECK(StemLoop::terminal(rule.terminal).has(rule.head));
+        } // end for
+    }
+
+    SECTION("Stem loop recognizer") {
+        // all strings up to length 7
+        const std::string nucleotides = "AGUC";
+        std::set<std::string> last = {""};
+
+        for (unsigned int length = 1; length <= 7; ++length) {
+            std::set<std::string> next;
+
+            for (const std::string& s : last) {
+                for (const char& c : nucleotides) {
+                    next.insert(s + c);
+                } // end for
+            } // end for
+
+            for (const std::string& s : next) {
+                INFO(s);
+                CHECK(StemLoop::recognize(s) == cnf.CYK(s, CYK_MATRIX));
+            } // end for
+
+            last = next;
+        } // end for
+
+        CHECK(StemLoop::recognize("GGGGAAAACCCC"));
+        CHECK_FALSE(StemLoop::recognize(""));
+        CHECK_THROWS_AS(StemLoop::recognize("GGTACC"), std::invalid_argument);
+    }
+
+    SECTION("Generator") {
+        const std::set<char> terminals = {'a', 'b'};
+        const std::set<char> variables = {'S'};
+        const std::multimap<char, SymbolString> productions = {
+                                                            {'S', "aSb"},
+                                                            {'S', "ab"}
+                                                            };
+
+        std::ostringstream header;
+        generateRecognizer(CNF(terminals, variables, productions, 'S'), "AnBn", header, "anbn.xml");
+
+        CHECK(std::string::npos != header.str().find("#ifndef H_ANBN_RECOGNIZER_H"));
+        CHECK(std::string::npos != header.str().find("namespace AnBn {"));
+        CHECK(std::string::npos != header.str().find("Generated from anbn.xml"));
+        CHECK(std::string::npos != header.str().find("constexpr std::size_t WORDS = 1;"));
+
+        CHECK_THROWS_AS(generateRecognizer(cnf, "Stem Loop", header), std::invalid_argument);
+        CHECK_THROWS_AS(generateRecognizer(cnf, "1StemLoop", header), std::invalid_argument);
+
+        // one long body, a variable for each prefix, needs more than one word
+        const std::multimap<char, SymbolString> longBody = {{'S', SymbolString(80, 'a')}};
+        std::ostringstream longHeader;
+        generateRecognizer(CNF(terminals, variables, longBody, 'S'), "Long", longHeader);
+        CHECK(std::string::npos != longHeader.str().find("constexpr std::size_t WORDS = 2;"));
+    }
+}